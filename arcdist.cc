@@ -21,13 +21,20 @@
 
 #include "arcdist.h"
 
-#include <cmath>                  // for round
+#include <algorithm>              // for clamp, merge, min
+#include <cmath>                  // for round, isfinite, hypot, floor, ceil, sin, cos, asin, atan2
 #include <cstdio>                 // for sscanf
+#include <iterator>               // for back_inserter
+#include <numbers>                // for pi
 #include <tuple>                  // for tie, tuple
+#include <utility>                // for as_const
 
 #include <QByteArray>             // for QByteArray
+#include <QHash>                  // for QHash
 #include <QString>                // for QString
-#include <QtGlobal>               // for foreach, qPrintable, qint64
+#include <QThread>                // for QThread
+#include <QThreadPool>            // for QThreadPool
+#include <QtGlobal>               // for foreach, qPrintable, qint64, qsizetype
 
 #include "defs.h"
 #include "grtcirc.h"              // for RAD, gcdist, linedistprj, radtomi
@@ -40,59 +47,167 @@
 
 #define BADVAL 999999
 
+ArcDistanceFilter::SegmentIndex::SegmentIndex(const std::vector<Segment>& segments, double dist_rad)
+{
+  /* Allow for rounding in the distance computations, about 6m. */
+  constexpr double kSlack = 1.0e-6;
+
+  struct Cap {
+    double lat;	/* degrees */
+    double lon;	/* degrees */
+    double radius;	/* degrees, < 0 => candidate everywhere */
+  };
+
+  std::vector<Cap> caps;
+  caps.reserve(segments.size());
+  double radius_sum = 0.0;
+  int nindexed = 0;
+  for (const auto& seg : segments) {
+    Cap cap{0.0, 0.0, -1.0};
+    if (std::isfinite(seg.pos1.latD) && std::isfinite(seg.pos1.lonD) &&
+        std::isfinite(seg.pos2.latD) && std::isfinite(seg.pos2.lonD)) {
+      const PositionRad p1 = seg.pos1;
+      const PositionRad p2 = seg.pos2;
+      const double x = cos(p1.lonR) * cos(p1.latR) + cos(p2.lonR) * cos(p2.latR);
+      const double y = sin(p1.latR) + sin(p2.latR);
+      const double z = sin(p1.lonR) * cos(p1.latR) + sin(p2.lonR) * cos(p2.latR);
+      const double radius = gcdist(p1, p2) / 2.0 + dist_rad + kSlack;
+      // Nearly antipodal vertices have no meaningful midpoint.
+      if ((radius < std::numbers::pi / 2) && (std::hypot(x, y, z) > 1.0e-6)) {
+        cap = {DEG(atan2(y, std::hypot(x, z))), DEG(atan2(z, x)), DEG(radius)};
+        radius_sum += cap.radius;
+        ++nindexed;
+      }
+    }
+    caps.push_back(cap);
+  }
+
+  // Size the cells to the typical cap, so that each cap covers a few cells.
+  double cell_deg = nindexed ? std::clamp(2.0 * radius_sum / nindexed, 1.0e-3, 90.0) : 90.0;
+  ncols_ = static_cast<int>(std::ceil(360.0 / cell_deg));
+  cell_deg_ = 360.0 / ncols_;
+  nrows_ = static_cast<int>(std::ceil(180.0 / cell_deg_));
+
+  auto row = [this](double lat)->int {
+    return std::clamp(static_cast<int>(std::floor((lat + 90.0) / cell_deg_)), 0, nrows_ - 1);
+  };
+  auto col = [this](double lon)->int {
+    return static_cast<int>(std::floor((lon + 180.0) / cell_deg_));
+  };
+
+  for (int i = 0; i < static_cast<int>(caps.size()); ++i) {
+    const Cap& cap = caps[i];
+    if (cap.radius < 0.0) {
+      global_.push_back(i);
+      continue;
+    }
+    const double lat_lo = cap.lat - cap.radius;
+    const double lat_hi = cap.lat + cap.radius;
+    const int row_lo = row(lat_lo);
+    const int row_hi = row(lat_hi);
+    int col_lo = 0;
+    int col_hi = ncols_ - 1;
+    if ((lat_lo > -90.0) && (lat_hi < 90.0)) {
+      // The cap doesn't contain a pole, so its longitude extent is bounded.
+      const double s = sin(RAD(cap.radius)) / cos(RAD(cap.lat));
+      if (s < 1.0) {
+        const double dlon = DEG(asin(s));
+        if (col(cap.lon + dlon) - col(cap.lon - dlon) + 1 < ncols_) {
+          col_lo = col(cap.lon - dlon);
+          col_hi = col(cap.lon + dlon);
+        }
+      }
+    }
+    if ((row_hi - row_lo + 1) * (col_hi - col_lo + 1) > kMaxCellsPerSegment) {
+      global_.push_back(i);
+      continue;
+    }
+    for (int r = row_lo; r <= row_hi; ++r) {
+      for (int c = col_lo; c <= col_hi; ++c) {
+        cells_[cell_id(r, ((c % ncols_) + ncols_) % ncols_)].push_back(i);
+      }
+    }
+  }
+}
+
+void ArcDistanceFilter::SegmentIndex::candidates(const PositionDeg& pos, std::vector<int>& result) const
+{
+  const int r = std::clamp(static_cast<int>(std::floor((pos.latD + 90.0) / cell_deg_)), 0, nrows_ - 1);
+  const int c = static_cast<int>(std::floor((pos.lonD + 180.0) / cell_deg_));
+  result.clear();
+  if (auto it = cells_.constFind(cell_id(r, ((c % ncols_) + ncols_) % ncols_)); it != cells_.cend()) {
+    std::merge(global_.cbegin(), global_.cend(), it->cbegin(), it->cend(), std::back_inserter(result));
+  } else {
+    result = global_;
+  }
+}
+
 void ArcDistanceFilter::arcdist_arc_disp_wpt_cb(const Waypoint* arcpt2)
 {
-  static const Waypoint* arcpt1 = nullptr;
-  PositionDeg prjpos;
-  double frac;
+  const Waypoint* arcpt1 = prev_arcpt;
 
   if (arcpt2 && arcpt2->latitude != BADVAL && arcpt2->longitude != BADVAL &&
       (ptsopt || (arcpt1 &&
                   (arcpt1->latitude != BADVAL && arcpt1->longitude != BADVAL)))) {
-    foreach (Waypoint* waypointp, *global_waypoint_list) {
-      extra_data* ed;
-      if (waypointp->extra_data) {
-        ed = (extra_data*) waypointp->extra_data;
+    Segment seg;
+    seg.pos2 = arcpt2->position();
+    seg.pos1 = ptsopt ? seg.pos2 : arcpt1->position();
+    // Vertices read from the arc file are temporaries.
+    seg.arcpt1 = arcfileopt ? nullptr : arcpt1;
+    seg.arcpt2 = arcfileopt ? nullptr : arcpt2;
+    segments.push_back(seg);
+  }
+  prev_arcpt = arcpt2;
+}
+
+/*
+ * Find the distance from pos to the arc, and with the project option
+ * the nearest point on the arc, considering the candidate segments in
+ * order, or all segments if there are no candidates.
+ */
+ArcDistanceFilter::extra_data ArcDistanceFilter::nearest(const PositionDeg& pos, const std::vector<int>* candidates) const
+{
+  extra_data ed{};
+  ed.distance = BADVAL;
+
+  auto test = [&](const Segment& seg)->void {
+    if (ed.distance == BADVAL || projectopt || ed.distance >= pos_dist) {
+      double dist;
+      PositionDeg prjpos;
+      double frac;
+      if (ptsopt) {
+        dist = gcdist(seg.pos2, pos);
+        prjpos = seg.pos2;
+        frac = 1.0;
       } else {
-        ed = new extra_data;
-        ed->distance = BADVAL;
+        std::tie(dist, prjpos, frac) = linedistprj(seg.pos1, seg.pos2, pos);
       }
-      if (ed->distance == BADVAL || projectopt || ed->distance >= pos_dist) {
-        double dist;
-        if (ptsopt) {
-          dist = gcdist(arcpt2->position(), waypointp->position());
-          prjpos = arcpt2->position();
-          frac = 1.0;
-        } else {
-          if (waypointp == nullptr) {
-            gbFatal(FatalMsg() << "Internal error. Attempt to project through a waypoint that doesn't exist");
-          }
-          if (arcpt1 == nullptr) {
-            gbFatal(FatalMsg() << "Internal error: Attempt to project waypoint without predecessor");
-          }
 
-          std::tie(dist, prjpos, frac) = linedistprj(arcpt1->position(),
-                                                     arcpt2->position(),
-                                                     waypointp->position());
-        }
+      /* convert radians to meters */
+      dist = radtometers(dist);
 
-        /* convert radians to meters */
-        dist = radtometers(dist);
-
-        if (ed->distance > dist) {
-          ed->distance = dist;
-          if (projectopt) {
-            ed->prjpos = prjpos;
-            ed->frac = frac;
-            ed->arcpt1 = arcpt1;
-            ed->arcpt2 = arcpt2;
-          }
+      if (ed.distance > dist) {
+        ed.distance = dist;
+        if (projectopt) {
+          ed.prjpos = prjpos;
+          ed.frac = frac;
+          ed.arcpt1 = seg.arcpt1;
+          ed.arcpt2 = seg.arcpt2;
         }
-        waypointp->extra_data = ed;
       }
     }
+  };
+
+  if (candidates) {
+    for (int i : *candidates) {
+      test(segments[i]);
+    }
+  } else {
+    for (const auto& seg : segments) {
+      test(seg);
+    }
   }
-  arcpt1 = arcpt2;
+  return ed;
 }
 
 void ArcDistanceFilter::arcdist_arc_disp_hdr_cb(const route_head* /*unused*/)
@@ -106,6 +221,9 @@ void ArcDistanceFilter::process()
   WayptFunctor<ArcDistanceFilter> arcdist_arc_disp_wpt_cb_f(this, &ArcDistanceFilter::arcdist_arc_disp_wpt_cb);
   RteHdFunctor<ArcDistanceFilter> arcdist_arc_disp_hdr_cb_f(this, &ArcDistanceFilter::arcdist_arc_disp_hdr_cb);
 
+  segments.clear();
+  prev_arcpt = nullptr;
+
   if (arcfileopt) {
     int fileline = 0;
     QString line;
@@ -151,6 +269,49 @@ void ArcDistanceFilter::process()
     track_disp_all(arcdist_arc_disp_hdr_cb_f, nullptr, arcdist_arc_disp_wpt_cb_f);
   }
 
+  if (!segments.empty()) {
+    const SegmentIndex index(segments, pos_dist / radtometers(1.0));
+    const qsizetype nwpts = global_waypoint_list->count();
+    std::vector<PositionDeg> positions;
+    positions.reserve(nwpts);
+    for (const Waypoint* wp : std::as_const(*global_waypoint_list)) {
+      positions.push_back(wp->position());
+    }
+
+    // Only segments near a waypoint can bring it within the distance.
+    // Waypoints that are not near any segment have to search the whole
+    // arc only if they will be kept and projected.
+    const bool full_search_far = projectopt && exclopt;
+    std::vector<extra_data> results(nwpts);
+    const qsizetype nchunks = std::min<qsizetype>(QThread::idealThreadCount(), (nwpts + 255) / 256);
+    QThreadPool pool;
+    for (qsizetype chunk = 0; chunk < nchunks; ++chunk) {
+      const qsizetype begin = nwpts * chunk / nchunks;
+      const qsizetype end = nwpts * (chunk + 1) / nchunks;
+      pool.start([&, begin, end]() {
+        std::vector<int> candidates;
+        for (qsizetype i = begin; i < end; ++i) {
+          const PositionDeg& pos = positions[i];
+          if (std::isfinite(pos.latD) && std::isfinite(pos.lonD)) {
+            index.candidates(pos, candidates);
+            results[i] = nearest(pos, &candidates);
+            if (full_search_far && (results[i].distance >= pos_dist)) {
+              results[i] = nearest(pos, nullptr);
+            }
+          } else {
+            results[i] = nearest(pos, nullptr);
+          }
+        }
+      });
+    }
+    pool.waitForDone();
+
+    qsizetype i = 0;
+    for (Waypoint* wp : std::as_const(*global_waypoint_list)) {
+      wp->extra_data = new extra_data(results[i++]);
+    }
+  }
+
   unsigned removed = 0;
   foreach (Waypoint* wp, *global_waypoint_list) {
     if (wp->extra_data) {
@@ -22,9 +22,13 @@
 #ifndef ARCDIST_H_INCLUDED_
 #define ARCDIST_H_INCLUDED_
 
+#include <vector>     // for vector
+
+#include <QHash>     // for QHash
 #include <QList>     // for QList
 #include <QString>   // for QString
 #include <QVector>   // for QVector
+#include <QtGlobal>  // for qint64
 
 #include "defs.h"    // for ARG_NOMINMAX, ARGTYPE_BOOL, Waypoint (ptr only)
 #include "filter.h"  // for Filter
@@ -53,14 +57,56 @@ private:
     const Waypoint* arcpt2;
   };
 
+  /*
+   * An arc segment, or with the points option a single arc vertex (pos2).
+   * The waypoints are only kept for routes and tracks.
+   */
+  struct Segment {
+    PositionDeg pos1;
+    PositionDeg pos2;
+    const Waypoint* arcpt1;
+    const Waypoint* arcpt2;
+  };
+
+  /*
+   * A grid over the sphere listing, for each cell, the segments that may
+   * lie within the filter distance of a point in that cell.  Each segment
+   * is bounded by the spherical cap around its midpoint, grown by the
+   * distance.  Segments whose caps are too large to be worth indexing are
+   * candidates everywhere.  Candidates are returned in segment order.
+   */
+  class SegmentIndex
+  {
+  public:
+    SegmentIndex(const std::vector<Segment>& segments, double dist_rad);
+    void candidates(const PositionDeg& pos, std::vector<int>& result) const;
+
+  private:
+    static constexpr int kMaxCellsPerSegment = 1024;
+
+    qint64 cell_id(int row, int col) const
+    {
+      return static_cast<qint64>(row) * ncols_ + col;
+    }
+
+    double cell_deg_{0.0};
+    int nrows_{1};
+    int ncols_{1};
+    std::vector<int> global_;
+    QHash<qint64, std::vector<int>> cells_;
+  };
+
   /* Member Functions */
 
   void arcdist_arc_disp_wpt_cb(const Waypoint* arcpt2);
   void arcdist_arc_disp_hdr_cb(const route_head* /*unused*/);
+  extra_data nearest(const PositionDeg& pos, const std::vector<int>* candidates) const;
 
   /* Data Members */
 
   double pos_dist{};
+  const Waypoint* prev_arcpt{nullptr};
+  std::vector<Segment> segments;
   OptionDouble distopt{true};
   OptionString arcfileopt;
   OptionBool rteopt;
@@ -23,7 +23,9 @@
 #include <cmath>            // macos wants abs from here!
 #include <cstdlib>          // for abs
 #include <utility>          // for as_const
+#include <vector>           // for vector
 
+#include <QList>            // for QList
 #include <QString>          // for QString
 #include <QtGlobal>         // for QForeachContainer, qMakeForeachContainer, foreach
 
@@ -83,7 +85,11 @@ int BendFilter::is_small_angle(const Waypoint* wpt_orig,
           || (std::abs(heading_diff - 360.0) < minAngle));
 }
 
-void BendFilter::process_route(const route_head* route_orig, route_head* route_dest)
+/*
+ * Build the wpts for the bent copy of route_orig.  This runs on a worker
+ * thread, see Filter::parallel_map_routes.
+ */
+void BendFilter::process_route(const route_head* route_orig, QList<Waypoint*>& wpts_dest) const
 {
   const Waypoint* wpt_orig_prev = nullptr;
   const Waypoint* wpt_orig = nullptr;
@@ -93,22 +99,22 @@ void BendFilter::process_route(const route_head* route_orig, route_head* route_d
     if (wpt_orig_prev == nullptr) {
       if (wpt_orig != nullptr) {
         auto* waypoint_dest = new Waypoint(*wpt_orig);
-        route_add_wpt(route_dest, waypoint_dest);
+        wpts_dest.append(waypoint_dest);
       }
     } else {
 
       if (is_small_angle(wpt_orig, wpt_orig_prev, wpt_orig_next)) {
         auto* waypoint_dest = new Waypoint(*wpt_orig);
-        route_add_wpt(route_dest, waypoint_dest);
+        wpts_dest.append(waypoint_dest);
       } else {
         Waypoint* wpt_dest_prev = create_wpt_dest(wpt_orig, wpt_orig_prev);
         if (wpt_dest_prev != nullptr) {
-          route_add_wpt(route_dest, wpt_dest_prev);
+          wpts_dest.append(wpt_dest_prev);
         }
 
         Waypoint* wpt_dest_next = create_wpt_dest(wpt_orig, wpt_orig_next);
         if (wpt_dest_next != nullptr) {
-          route_add_wpt(route_dest, wpt_dest_next);
+          wpts_dest.append(wpt_dest_next);
 
           wpt_orig = wpt_dest_next;
         }
@@ -121,11 +127,11 @@ void BendFilter::process_route(const route_head* route_orig, route_head* route_d
 
   if (wpt_orig != nullptr) {
     auto* waypoint_dest = new Waypoint(*wpt_orig);
-    route_add_wpt(route_dest, waypoint_dest);
+    wpts_dest.append(waypoint_dest);
   }
 }
 
-void BendFilter::process_route_orig(const route_head* route_orig)
+void BendFilter::process_route_orig(const route_head* route_orig, const QList<Waypoint*>& wpts_dest)
 {
   auto* route_dest = new route_head;
   route_dest->rte_name = route_orig->rte_name;
@@ -135,13 +141,19 @@ void BendFilter::process_route_orig(const route_head* route_orig)
 
   route_add_head(route_dest);
 
-  process_route(route_orig, route_dest);
+  route_add_wpts(route_dest, wpts_dest);
 }
 
 void BendFilter::process()
 {
+  const std::vector<RouteResult> results = parallel_map_routes(*routes_orig, [this](const route_head* route_orig, RouteResult& result)->void {
+    process_route(route_orig, result.wpts);
+  });
+
+  auto result = results.cbegin();
   for (const auto* route_orig : std::as_const(*routes_orig)) {
-    process_route_orig(route_orig);
+    process_route_orig(route_orig, result->wpts);
+    ++result;
   }
 }
 
@@ -68,8 +68,8 @@ private:
   int is_small_angle(const Waypoint* wpt_orig,
                      const Waypoint* wpt_orig_prev,
                      const Waypoint* wpt_orig_next) const;
-  void process_route(const route_head* route_orig, route_head* route_dest);
-  void process_route_orig(const route_head* route_orig);
+  void process_route(const route_head* route_orig, QList<Waypoint*>& wpts_dest) const;
+  void process_route_orig(const route_head* route_orig, const QList<Waypoint*>& wpts_dest);
 
 };
 
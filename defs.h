@@ -51,6 +51,14 @@
 #include "src/core/datetime.h"       // for DateTime
 
 
+namespace gpsbabel
+{
+/* Defined in src/core/keysort.h, which only the users of sort_by_key need to include. */
+template <typename Iter, typename KeyFn>
+void stable_sort_by_key(Iter first, Iter last, KeyFn key_of);
+} // namespace gpsbabel
+
+
 #define gbLogCStr(qstr) qUtf8Printable(qstr)
 #define CSTR(qstr) ((qstr).toUtf8().constData())
 #define CSTRc(qstr) ((qstr).toLatin1().constData())
@@ -466,6 +474,9 @@ public:
   void* extra_data;	/* Extra data added by, say, a filter. */
 };
 
+/* Readers size lists from counts in the file, which may be corrupt; don't reserve more than this up front. */
+constexpr int kMaxReserve = 1 << 20;
+
 using waypt_cb = void (*)(const Waypoint*);
 
 // TODO: Consider using composition instead of private inheritance.
@@ -473,7 +484,9 @@ class WaypointList : private QList<Waypoint*>
 {
 public:
   void waypt_add(Waypoint* wpt); // a.k.a. append(), push_back()
+  void reserve(qsizetype n); // a.k.a. QList::reserve(), n is the total size expected
   void add_rte_waypt(int waypt_ct, Waypoint* wpt, bool synth, QStringView namepart, int number_digits);
+  void add_rte_waypts(int waypt_ct, const QList<Waypoint*>& wpts, bool synth, QStringView namepart, int number_digits);
   // FIXME: Generally it is inefficient to use an element pointer or reference to define the element to be deleted, use iterator instead,
   //        and/or implement pop_back() a.k.a. removeLast(), and/or pop_front() a.k.a. removeFirst().
   void waypt_del(Waypoint* wpt); // a.k.a. erase()
@@ -487,8 +500,11 @@ public:
   void copy(WaypointList** dst) const;
   void restore(WaypointList* src);
   void swap(WaypointList& other);
+  void splice(WaypointList& src); // move all of src to the end, src is left empty
   template <typename Compare>
   void sort(Compare cmp) {std::stable_sort(begin(), end(), cmp);}
+  template <typename KeyFn>
+  void sort_by_key(KeyFn key_of) {gpsbabel::stable_sort_by_key(begin(), end(), key_of);}
   template <typename T>
   void waypt_disp_session(const session_t* se, T cb);
 
@@ -518,6 +534,7 @@ public:
 void waypt_init();
 //void update_common_traits(const Waypoint* wpt);
 void waypt_add(Waypoint* wpt);
+void waypt_reserve(qsizetype n);
 void waypt_del(Waypoint* wpt);
 void del_marked_wpts();
 int waypt_count();
@@ -535,6 +552,7 @@ void waypt_append(WaypointList* src);
 void waypt_backup(WaypointList** head_bak);
 void waypt_restore(WaypointList* head_bak);
 void waypt_swap(WaypointList& other);
+void waypt_splice(WaypointList& src);
 template <typename Compare>
 void waypt_sort(Compare cmp)
 {
@@ -542,6 +560,13 @@ void waypt_sort(Compare cmp)
 
   global_waypoint_list->sort(cmp);
 }
+template <typename KeyFn>
+void waypt_sort_by_key(KeyFn key_of)
+{
+  extern WaypointList* global_waypoint_list;
+
+  global_waypoint_list->sort_by_key(key_of);
+}
 void waypt_add_url(Waypoint* wpt, const QString& link,
                    const QString& url_link_text);
 void waypt_add_url(Waypoint* wpt, const QString& link,
@@ -657,6 +682,7 @@ public:
   // FIXME: Generally it is inefficient to use an element pointer or reference to define the insertion point, use iterator instead.
   void insert_head(route_head* rte, route_head* predecessor); // a.k.a. insert
   void add_wpt(route_head* rte, Waypoint* wpt, bool synth, QStringView namepart, int number_digits);
+  void add_wpts(route_head* rte, const QList<Waypoint*>& wpts, bool synth, QStringView namepart, int number_digits);
   // FIXME: Generally it is inefficient to use an element pointer or reference to define the insertion point, use iterator instead.
   void del_wpt(route_head* rte, Waypoint* wpt);
   void del_marked_wpts(route_head* rte);
@@ -665,9 +691,12 @@ public:
   void copy(RouteList** dst) const;
   void restore(RouteList* src);
   void swap(RouteList& other);
+  void splice(RouteList& src); // move all of src to the end, src is left empty
   void swap_wpts(route_head* rte, WaypointList& other);
   template <typename Compare>
   void sort(Compare cmp) {std::sort(begin(), end(), cmp);}
+  template <typename KeyFn>
+  void sort_by_key(KeyFn key_of) {gpsbabel::stable_sort_by_key(begin(), end(), key_of);}
   template <typename T1, typename T2, typename T3>
   void disp_all(T1 rh, T2 rt, T3 wc);
   template <typename T2, typename T3>
@@ -718,6 +747,8 @@ void track_del_head(route_head* rte);
 void track_insert_head(route_head* rte, route_head* predecessor);
 void route_add_wpt(route_head* rte, Waypoint* wpt, QStringView namepart = u"RPT", int number_digits = 3);
 void track_add_wpt(route_head* rte, Waypoint* wpt, QStringView namepart = u"RPT", int number_digits = 3);
+void route_add_wpts(route_head* rte, const QList<Waypoint*>& wpts, QStringView namepart = u"RPT", int number_digits = 3);
+void track_add_wpts(route_head* rte, const QList<Waypoint*>& wpts);
 void route_del_wpt(route_head* rte, Waypoint* wpt);
 void track_del_wpt(route_head* rte, Waypoint* wpt);
 void route_del_marked_wpts(route_head* rte);
@@ -738,6 +769,7 @@ void track_append(const RouteList* src);
 void route_backup(RouteList** head_bak);
 void route_restore(RouteList* head_bak);
 void route_swap(RouteList& other);
+void route_splice(RouteList& src);
 template <typename Compare>
 void route_sort(Compare cmp)
 {
@@ -745,9 +777,17 @@ void route_sort(Compare cmp)
 
   global_route_list->sort(cmp);
 }
+template <typename KeyFn>
+void route_sort_by_key(KeyFn key_of)
+{
+  extern RouteList* global_route_list;
+
+  global_route_list->sort_by_key(key_of);
+}
 void track_backup(RouteList** head_bak);
 void track_restore(RouteList* head_bak);
 void track_swap(RouteList& other);
+void track_splice(RouteList& src);
 template <typename Compare>
 void track_sort(Compare cmp)
 {
@@ -755,6 +795,13 @@ void track_sort(Compare cmp)
 
   global_track_list->sort(cmp);
 }
+template <typename KeyFn>
+void track_sort_by_key(KeyFn key_of)
+{
+  extern RouteList* global_track_list;
+
+  global_track_list->sort_by_key(key_of);
+}
 computed_trkdata track_recompute(const route_head* trk);
 
 template <typename T>
@@ -320,12 +320,12 @@ ExifFormat::exif_load_apps()
     app->marker = gbfgetuint16(fin_);
     app->len = gbfgetuint16(fin_);
     if (global_opts.debug_level >= 3) {
-      gbDebug("api = %02X, len = %u (0x%04x), offs = 0x%08X\n", app->marker & 0xFF, app->len, app->len, gbftell(fin_));
+      gbDebug("api = %02X, len = %u (0x%04x), offs = 0x%08llX\n", app->marker & 0xFF, app->len, app->len, static_cast<unsigned long long>(gbftell(fin_)));
     }
     if (exif_app_ || (app->marker == 0xFFDA)) { /* compressed data */
       gbfcopyfrom(app->fcache, fin_, 0x7FFFFFFF);
       if (global_opts.debug_level >= 3) {
-        gbDebug("compressed data size = %u\n", gbftell(app->fcache));
+        gbDebug("compressed data size = %lld\n", static_cast<long long>(gbftell(app->fcache)));
       }
     } else {
       gbfcopyfrom(app->fcache, fin_, app->len - 2);
@@ -412,7 +412,7 @@ ExifFormat::exif_read_ifd(ExifApp* app, const uint16_t ifd_nr, const gbsize_t of
     ifd->tags.append(ExifTag());
     ExifTag* tag = &ifd->tags.last();
     if (global_opts.debug_level >= 3) {
-      tag->tag_offset = gbftell(fin);
+      tag->tag_offset = static_cast<uint32_t>(gbftell(fin));
     }
 
     tag->id = gbfgetuint16(fin);
@@ -473,7 +473,7 @@ ExifFormat::exif_read_ifd(ExifApp* app, const uint16_t ifd_nr, const gbsize_t of
 
   gbsize_t next_ifd_offs;
   if (global_opts.debug_level >= 3) {
-    next_ifd_offs = gbftell(fin);
+    next_ifd_offs = static_cast<gbsize_t>(gbftell(fin));
   }
   ifd->next_ifd = gbfgetuint32(fin);
 
@@ -1234,7 +1234,7 @@ void
 ExifFormat::exif_write_ifd(ExifIfd* ifd, const char next, gbfile* fout)
 {
   gbfputuint16(ifd->count, fout);
-  gbsize_t offs = gbftell(fout) + (ifd->count * 12) + 4;
+  gbsize_t offs = static_cast<gbsize_t>(gbftell(fout)) + (ifd->count * 12) + 4;	/* TIFF offsets are 32 bits */
 
   for (auto& tag_instance : ifd->tags) {
     ExifTag* tag = &tag_instance;
@@ -1403,7 +1403,7 @@ ExifFormat::exif_write_apps()
         gbfcopyfrom(ftmp, app->fexif, segment.second);
       }
 
-      len = gbftell(ftmp);
+      len = static_cast<uint32_t>(gbftell(ftmp));
       gbfrewind(ftmp);
       gbfputuint16(len + 8, fout_);
       gbfwrite("Exif\0\0", 6, 1, fout_);
@@ -20,11 +20,22 @@
 #ifndef FILTER_H_INCLUDED_
 #define FILTER_H_INCLUDED_
 
+#include <algorithm>    // for min
+#include <atomic>       // for atomic
+#include <vector>       // for vector
+
+#include <QList>        // for QList
+#include <QString>      // for QString
+#include <QThread>      // for QThread
+#include <QThreadPool>  // for QThreadPool
+
 #include "defs.h"
 
-// Filter have access to the global_waypoint_list, which formats really
+// Filter have access to the global lists, which formats really
 // shouldn't have.
 extern WaypointList* global_waypoint_list;
+extern RouteList* global_route_list;
+extern RouteList* global_track_list;
 
 class Filter
 {
@@ -88,6 +99,60 @@ public:
   }
 
 protected:
+  /* Result of processing one route with parallel_map_routes(). */
+  struct RouteResult {
+    QList<Waypoint*> wpts;	/* waypoints for the route, in order */
+    QString error;		/* if not empty, a fatal error for this route */
+  };
+
+  /*
+   * Call fn(rte, result) for every route in routes.  Routes are
+   * independent, so when there is enough work they are spread over a
+   * thread pool.  The results come back in route order, and the caller
+   * applies them to the global lists (or reports their errors) on the
+   * main thread, which keeps the output identical to a serial run.
+   *
+   * fn runs concurrently for different routes.  It may read its route
+   * and the filter's settings and create or copy Waypoints, but must not
+   * modify the global lists or other shared state, and must report
+   * errors in result.error instead of calling gbFatal.
+   */
+  template <typename Fn>
+  static std::vector<RouteResult> parallel_map_routes(const RouteList& routes, Fn fn)
+  {
+    std::vector<const route_head*> heads;
+    heads.reserve(routes.count());
+    qsizetype nwpts = 0;
+    for (const route_head* rte : routes) {
+      heads.push_back(rte);
+      nwpts += rte->rte_waypt_ct();
+    }
+    const qsizetype nroutes = heads.size();
+    std::vector<RouteResult> results(nroutes);
+
+    const qsizetype nthreads = std::min<qsizetype>(QThread::idealThreadCount(), nroutes);
+    if ((nthreads < 2) || (nwpts < kParallelMinWaypts)) {
+      for (qsizetype i = 0; i < nroutes; ++i) {
+        fn(heads[i], results[i]);
+      }
+      return results;
+    }
+
+    // Route sizes vary wildly, so instead of handing out fixed chunks
+    // every worker keeps taking the next unprocessed route.
+    std::atomic<qsizetype> next{0};
+    QThreadPool pool;
+    for (qsizetype t = 0; t < nthreads; ++t) {
+      pool.start([&heads, &results, &next, &fn, nroutes]() {
+        for (qsizetype i = next++; i < nroutes; i = next++) {
+          fn(heads[i], results[i]);
+        }
+      });
+    }
+    pool.waitForDone();
+    return results;
+  }
+
   template <class MyFilter>
   class RteHdFunctor
   {
@@ -120,5 +185,8 @@ protected:
     WayptCb _cb;
   };
 
+private:
+  // Below this many waypoints in total the thread pool isn't worth it.
+  static constexpr qsizetype kParallelMinWaypts = 16 * 1024;
 };
 #endif // FILTER_H_INCLUDED_
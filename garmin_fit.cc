@@ -31,15 +31,14 @@
 
 #include <QByteArray>          // for QByteArray
 #include <QDateTime>           // for QDateTime
-#include <QFileInfo>           // for QFileInfo
 #include <QLatin1Char>         // for QLatin1Char
 #include <QString>             // for QString
 #include <Qt>                  // for CaseInsensitive
-#include <QtGlobal>            // for uint, qint64
+#include <QtGlobal>            // for uint
 
 #include "defs.h"
 #include "garmin_fit.h"
-#include "gbfile.h"            // for gbfputc, gbfputuint16, gbfputuint32, gbfgetc, gbfread, gbfseek, gbfclose, gbfgetuint16, gbfopen_le, gbfputint32, gbfflush, gbfgetuint32, gbfputs, gbftell, gbfwrite, gbfile, gbsize_t
+#include "gbfile.h"            // for gbfputc, gbfputuint16, gbfputuint32, gbfgetc, gbfread, gbfseek, gbfclose, gbfgetuint16, gbfopen_le, gbfputint32, gbfflush, gbfgetuint32, gbfputs, gbftell, gbfwrite, gbfile, gbsize_t, gbfoff_t
 #include "jeeps/gpsmath.h"     // for GPS_Math_Semi_To_Deg, GPS_Math_Gtime_To_Utime, GPS_Math_Deg_To_Semi, GPS_Math_Utime_To_Gtime
 #include "src/core/logging.h"  // for Warning, Fatal
 
@@ -141,10 +140,9 @@ GarminFitFormat::fit_parse_header()
     }
   }
 
-  QFileInfo fi(fin->name);
-  qint64 size = fi.size();
-  if ((len + fit_data.len + 2) != size) {
-    Warning().nospace() << "File size " << size << " is not expected given header len " << len << ", data length " << fit_data.len << " and a 2 byte file CRC.";
+  // The size is what we read, a compressed file is larger or smaller on disk.
+  if ((len + fit_data.len + 2) != fit_data.file_size) {
+    Warning().nospace() << "File size " << fit_data.file_size << " is not expected given header len " << len << ", data length " << fit_data.len << " and a 2 byte file CRC.";
   } else if (global_opts.debug_level >= 1) {
     Debug(1) << "File size matches expectations from information in the header.";
   }
@@ -776,7 +774,7 @@ GarminFitFormat::fit_parse_compressed_message(uint8_t header)
 void
 GarminFitFormat::fit_parse_record()
 {
-  gbsize_t position = gbftell(fin);
+  gbfoff_t position = gbftell(fin);
   uint8_t header = fit_getuint8();
   // high bit 7 set -> compressed message (0 for normal)
   // second bit 6 set -> 0 for data message, 1 for definition message
@@ -810,12 +808,12 @@ GarminFitFormat::fit_parse_record()
   }
 }
 
-void
+gbfoff_t
 GarminFitFormat::fit_check_file_crc() const
 {
   // Check file CRC
 
-  gbsize_t position = gbftell(fin);
+  gbfoff_t position = gbftell(fin);
 
   uint16_t crc = 0;
   gbfseek(fin, 0, SEEK_SET);
@@ -826,6 +824,7 @@ GarminFitFormat::fit_check_file_crc() const
     }
     crc = fit_crc16(data, crc);
   }
+  gbfoff_t size = gbftell(fin);
   if (crc != 0) {
     Warning().nospace() << "File CRC mismatch in file " <<  fin->name << ".";
     if (!opt_recoverymode) {
@@ -836,6 +835,7 @@ GarminFitFormat::fit_check_file_crc() const
   }
 
   gbfseek(fin, position, SEEK_SET);
+  return size;
 }
 
 /*******************************************************************************
@@ -846,7 +846,7 @@ GarminFitFormat::fit_check_file_crc() const
 void
 GarminFitFormat::read()
 {
-  fit_check_file_crc();
+  fit_data.file_size = fit_check_file_crc();
 
   fit_parse_header();
 
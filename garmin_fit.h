@@ -38,7 +38,7 @@
 
 #include "defs.h"
 #include "format.h"             // for Format
-#include "gbfile.h"             // for gbfile
+#include "gbfile.h"             // for gbfile, gbfoff_t
 #include "option.h"             // for OptionBool
 #include "src/core/datetime.h"  // for DateTime
 
@@ -90,6 +90,7 @@ private:
   struct fit_data_t {
     int len{};
     int endian{};
+    gbfoff_t file_size{};
     route_head* track{nullptr};
     uint32_t last_timestamp{};
     uint32_t global_utc_offset{};
@@ -237,7 +238,7 @@ private:
   void fit_parse_data_message(uint8_t header);
   void fit_parse_compressed_message(uint8_t header);
   void fit_parse_record();
-  void fit_check_file_crc() const;
+  gbfoff_t fit_check_file_crc() const;
   void fit_write_message_def(uint8_t local_id, uint16_t global_id, const std::vector<fit_field_t>& fields) const;
   static uint16_t fit_crc16(uint8_t data, uint16_t crc);
   void fit_write_timestamp(const gpsbabel::DateTime& t) const;
@@ -42,7 +42,7 @@
 #include "defs.h"
 #include "formspec.h"              // for FormatSpecificDataList
 #include "garmin_fs.h"             // for garmin_fs_t
-#include "gbfile.h"                // for gbfputint32, gbfgetint32, gbfgetint16, gbfputint16, gbfgetc, gbfputc, gbfread, gbftell, gbfwrite, gbfseek, gbfclose, gbfopen_le, gbfgetuint16, gbsize_t, gbfile
+#include "gbfile.h"                // for gbfputint32, gbfgetint32, gbfgetint16, gbfputint16, gbfgetc, gbfputc, gbfread, gbftell, gbfwrite, gbfseek, gbfclose, gbfopen_le, gbfgetuint16, gbsize_t, gbfoff_t, gbfile
 #include "jeeps/gpsmath.h"         // for GPS_Math_Deg_To_Semi, GPS_Math_Semi_To_Deg
 
 
@@ -59,7 +59,7 @@
 #define GPI_BITMAP_SIZE sizeof(gpi_bitmap)
 
 #define GPI_DBG global_opts.debug_level >= 3
-#define PP if (GPI_DBG) gbDebug("@%6x (%8d): ", gbftell(fin), gbftell(fin))
+#define PP if (GPI_DBG) gbDebug("@%6llx (%8lld): ", static_cast<long long>(gbftell(fin)), static_cast<long long>(gbftell(fin)))
 
 /*******************************************************************************
 * %%%                             gpi reader                               %%% *
@@ -237,7 +237,7 @@ GarminGPIFormat::read_poi(const int sz, const int tag)
   gbDebug("poi sublen = %d (0x%x)\n", len, len);
   }
   (void) len;
-  int pos = gbftell(fin);
+  gbfoff_t pos = gbftell(fin);
 
   auto* wpt = new Waypoint;
   wpt->icon_descr = DEFAULT_ICON;
@@ -249,7 +249,7 @@ GarminGPIFormat::read_poi(const int sz, const int tag)
   (void) gbfgetc(fin);    /* seems to 1 when extra options present */
   wpt->shortname = gpi_read_string("Shortname");
 
-  while (gbftell(fin) < (gbsize_t)(pos + sz - 4)) {
+  while (gbftell(fin) < pos + sz - 4) {
     int skip_tag = gbfgetint32(fin);
     if (! read_tag("read_poi", skip_tag, wpt)) {
       break;
@@ -275,10 +275,10 @@ GarminGPIFormat::read_poi(const int sz, const int tag)
 void
 GarminGPIFormat::read_poi_list(const int sz)
 {
-  int pos = gbftell(fin);
+  gbfoff_t pos = gbftell(fin);
   if (GPI_DBG) {
     PP;
-    gbDebug("> reading poi list (-> %x / %d )\n", pos + sz, pos + sz);
+    gbDebug("> reading poi list (-> %llx / %lld )\n", static_cast<long long>(pos + sz), static_cast<long long>(pos + sz));
   }
   PP;
   int i = gbfgetint32(fin);  /* mostly 23 (0x17) */
@@ -298,7 +298,7 @@ GarminGPIFormat::read_poi_list(const int sz)
 
   (void) gbfgetint32(fin);  /* ? const 0x1000100 ? */
 
-  while (gbftell(fin) < (gbsize_t)(pos + sz - 4)) {
+  while (gbftell(fin) < pos + sz - 4) {
     int tag = gbfgetint32(fin);
     if (! read_tag("read_poi_list", tag, nullptr)) {
       return;
@@ -313,22 +313,22 @@ GarminGPIFormat::read_poi_list(const int sz)
 void
 GarminGPIFormat::read_poi_group(const int sz, const int tag)
 {
-  int pos = gbftell(fin);
+  gbfoff_t pos = gbftell(fin);
   if (GPI_DBG) {
     PP;
-    gbDebug("> reading poi group (-> %x / %d)\n", pos + sz, pos + sz);
+    gbDebug("> reading poi group (-> %llx / %lld)\n", static_cast<long long>(pos + sz), static_cast<long long>(pos + sz));
   }
   if (tag == 0x80009) {
     PP;
     int subsz = gbfgetint32(fin);  /* ? offset to category data ? */
     if (GPI_DBG) {
-      gbDebug("group sublen = %d (-> %x / %d)\n", subsz, pos + subsz + 4, pos + subsz + 4);
+      gbDebug("group sublen = %d (-> %llx / %lld)\n", subsz, static_cast<long long>(pos + subsz + 4), static_cast<long long>(pos + subsz + 4));
     }
     (void)subsz;
   }
   rdata->group = gpi_read_string("Group");
 
-  while (gbftell(fin) < (gbsize_t)(pos + sz)) {
+  while (gbftell(fin) < pos + sz) {
     int subtag = gbfgetint32(fin);
     if (! read_tag("read_poi_group", subtag, nullptr)) {
       break;
@@ -359,7 +359,7 @@ GarminGPIFormat::read_tag(const char* caller, const int tag, Waypoint* wpt)
   garmin_fs_t* gmsd;
 
   int sz = gbfgetint32(fin);
-  int pos = gbftell(fin);
+  gbfoff_t pos = gbftell(fin);
 
   if (GPI_DBG) {
     PP;
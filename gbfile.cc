@@ -23,6 +23,9 @@
 #include <QByteArray>          // for QByteArray
 #include <QChar>               // for QChar, operator==, operator!=
 #include <QDebug>              // for QDebug
+#include <QFile>               // for QFile
+#include <QFileDevice>         // for QFileDevice
+#include <QIODevice>           // for QIODevice
 #include <QString>             // for QString
 #include <Qt>                  // for CaseInsensitive
 #include <QtGlobal>            // for qPrintable
@@ -30,11 +33,13 @@
 #include <cassert>             // for assert
 #include <cctype>              // for tolower
 #include <cstdarg>             // for va_list, va_end, va_copy, va_start
-#include <cstdio>              // for EOF, ferror, ftell, SEEK_SET, SEEK_CUR, SEEK_END, clearerr, fclose, feof, fflush, fileno, fread, fseek, fwrite, ungetc, vsnprintf, FILE, stdin, stdout
-#include <cstring>             // for memcpy, strlen, strchr, strcpy, strncat
+#include <cstdio>              // for EOF, ferror, fseeko, ftello, SEEK_SET, SEEK_CUR, SEEK_END, clearerr, fclose, feof, fflush, fileno, fread, fwrite, ungetc, vsnprintf, FILE, stdin, stdout
+#include <cstring>             // for memcpy, strlen, strchr
+#include <memory>              // for unique_ptr, make_unique
 
 #include "defs.h"
 #include "gbfile.h"
+#include "src/core/gzipstream.h"
 #include "src/core/logging.h"
 
 #if __WIN32__
@@ -42,8 +47,14 @@
 #  include <fcntl.h>
 #  include <io.h>
 #  define SET_BINARY_MODE(file) _setmode(fileno(file), O_BINARY)
+/* long is only 32 bits here, use the 64-bit variants to reach beyond 2 GiB. */
+#  define gb_fseek(stream, offset, whence) _fseeki64(stream, offset, whence)
+#  define gb_ftell(stream) _ftelli64(stream)
 #else
 #  define SET_BINARY_MODE(file)
+/* off_t is 64 bits as we build with _FILE_OFFSET_BITS=64. */
+#  define gb_fseek(stream, offset, whence) fseeko(stream, offset, whence)
+#  define gb_ftell(stream) ftello(stream)
 #endif
 
 #define NO_ZLIB "No zlib support.\n"
@@ -68,20 +79,39 @@
 /* %%%                            Zlib file api                            %%% */
 /*******************************************************************************/
 
+/*
+ * Decompression runs on a helper thread ahead of the reader and
+ * compression on a thread pool, see src/core/gzipstream.h.
+ * Every file we read comes here.  Plain files that can seek are read
+ * from the QFile directly, with neither reader nor writer, and pipes
+ * are passed through the reader transparently.
+ */
+struct gbgzfile {
+  QFile file;
+  std::unique_ptr<gpsbabel::GzipReader> reader;
+  std::unique_ptr<gpsbabel::GzipWriter> writer;
+};
+
+/* Does the stream start like a gzip member?  Peeking leaves the bytes for the reader. */
+static bool
+gz_magic(QFile& file)
+{
+  char magic[2];
+  return (file.peek(magic, 2) == 2) && (magic[0] == '\x1f') && (magic[1] == '\x8b');
+}
+
 static gbfile*
 gzapi_open(gbfile* self, const char* mode)
 {
-  char openmode[32];
+  (void)mode;
 
   self->gzapi = 1;
 
-  /* under non-posix systems files MUST be opened in binary mode */
-
-  strcpy(openmode, mode);
-  if (strchr(mode, 'b') == nullptr) {
-    strncat(openmode, "b", sizeof(openmode) - strlen(openmode) - 1);
-  }
-
+  auto* gz = new gbgzfile;
+  QIODevice::OpenMode openmode = (self->mode == 'r') ?
+                                 QIODevice::OpenMode(QIODevice::ReadOnly) :
+                                 (QIODevice::WriteOnly | QIODevice::Truncate);
+  bool ok;
   if (self->is_pipe) {
     FILE* fd;
     if (self->mode == 'r') {
@@ -89,45 +119,84 @@ gzapi_open(gbfile* self, const char* mode)
     } else {
       fd = stdout;
     }
+    /* under non-posix systems files MUST be opened in binary mode */
     SET_BINARY_MODE(fd);
-    self->handle.gz = gzdopen(fileno(fd), openmode);
+    ok = gz->file.open(fd, openmode);
   } else {
-#if __WIN32__
-    // On Windows, convert to wchar_t[] and use gzopen_w().
-    self->handle.gz = gzopen_w((const wchar_t*) self->name.utf16(), openmode);
-#else
-    // On other platforms, convert to native locale (UTF-8 or other 8-bit).
-    self->handle.gz = gzopen(qPrintable(self->name), openmode);
-#endif
+    gz->file.setFileName(self->name);
+    ok = gz->file.open(openmode);
   }
 
-  if (self->handle.gz == nullptr) {
+  if (!ok) {
+    delete gz;
     gbFatal("Cannot %s file '%s'!\n",
           (self->mode == 'r') ? "open" : "create",
           gbLogCStr(self->name));
   }
 
+  if (self->mode == 'r') {
+    /* We can't peek at a pipe without taking the bytes, so let the reader look. */
+    if (gz->file.isSequential() || gz_magic(gz->file)) {
+      gz->reader = std::make_unique<gpsbabel::GzipReader>(&gz->file);
+    }
+  } else {
+    gz->writer = std::make_unique<gpsbabel::GzipWriter>(&gz->file);
+  }
+  self->handle.gz = gz;
+
   return self;
 }
 
 static int
 gzapi_close(gbfile* self)
 {
-  return gzclose(self->handle.gz);
+  gbgzfile* gz = self->handle.gz;
+
+  if (gz->writer) {
+    if (!gz->writer->finish()) {
+      gbFatal("Could not write to %s (%s)!\n",
+            gbLogCStr(self->name), gbLogCStr(gz->writer->errorString()));
+    }
+    if (!gz->file.flush()) {
+      gbFatal("Could not write to %s (%s)!\n",
+            gbLogCStr(self->name), gbLogCStr(gz->file.errorString()));
+    }
+  }
+  gz->reader.reset();
+  gz->writer.reset();
+  gz->file.close();
+  if (gz->file.error() != QFileDevice::NoError) {
+    gbFatal("Could not close %s (%s)!\n",
+          gbLogCStr(self->name), gbLogCStr(gz->file.errorString()));
+  }
+  delete gz;
+  self->handle.gz = nullptr;
+
+  return 0;
 }
 
 static int
-gzapi_seek(gbfile* self, int32_t offset, int whence)
+gzapi_seek(gbfile* self, gbfoff_t offset, int whence)
 {
   assert(whence != SEEK_END);
+  gbgzfile* gz = self->handle.gz;
 
   if ((whence == SEEK_CUR) && (self->back != -1)) {
     offset--;
   }
-  int result = gzseek(self->handle.gz, offset, whence);
   self->back = -1;
 
-  if (result < 0) {
+  bool ok;
+  if (gz->reader) {
+    ok = gz->reader->seek((whence == SEEK_CUR) ? gz->reader->pos() + offset : offset);
+  } else if (self->mode == 'r') {
+    ok = gz->file.seek((whence == SEEK_CUR) ? gz->file.pos() + offset : offset);
+  } else {
+    /* A compressed stream can't be rewritten, so only null seeks are allowed. */
+    ok = ((whence == SEEK_CUR) ? offset : offset - gz->writer->pos()) == 0;
+  }
+
+  if (!ok) {
     if (self->is_pipe) {
       gbFatal("This format cannot be used in piped commands!\n");
     }
@@ -139,9 +208,11 @@ gzapi_seek(gbfile* self, int32_t offset, int whence)
 static gbsize_t
 gzapi_read(void* buf, const gbsize_t size, const gbsize_t members, gbfile* self)
 {
-  int result = 0;
+  gbgzfile* gz = self->handle.gz;
+  gpsbabel::GzipReader* reader = gz->reader.get();
+  qint64 result = 0;
   char* target = (char*) buf;
-  int count = size * members;
+  qint64 count = static_cast<qint64>(size) * members;
 
   if (self->back != -1) {
     *target++ = self->back;
@@ -149,27 +220,28 @@ gzapi_read(void* buf, const gbsize_t size, const gbsize_t members, gbfile* self)
     result++;
     self->back = -1;
   }
-  result += gzread(self->handle.gz, target, count);
+  qint64 got = reader ? reader->read(target, count) : gz->file.read(target, count);
+  if (got > 0) {
+    result += got;
+  }
 
   /* Check for an incomplete READ */
-  if ((members == 1) && (size > 1) && (result > 0) && (result < (int)size)) {
+  if ((members == 1) && (size > 1) && (result > 0) && (result < (qint64)size)) {
     gbFatal("Unexpected end of file (EOF)!\n");
   }
 
   result /= size;
 
-  if ((result < 0) || ((gbsize_t)result < members)) {
-    int errnum;
-
-    const char* errtxt = gzerror(self->handle.gz, &errnum);
-
-    /* Workaround for zlib bug: buffer error on empty files */
-    if ((errnum == Z_BUF_ERROR) && (gztell(self->handle.gz) == 0)) {
-      return (gbsize_t) 0;
+  if (!reader) {
+    if (got < 0) {
+      gbFatal("Could not read from %s (%s)!\n",
+            gbLogCStr(self->name), gbLogCStr(gz->file.errorString()));
     }
-    if ((errnum != Z_STREAM_END) && (errnum != 0))
+  } else if ((got < 0) || (result < members)) {
+    int errnum = reader->error();
+    if (errnum != Z_OK)
       gbFatal("zlib returned error %d ('%s')!\n",
-            errnum, errtxt);
+            errnum, gbLogCStr(reader->errorString()));
   }
   return (gbsize_t) result;
 }
@@ -177,19 +249,39 @@ gzapi_read(void* buf, const gbsize_t size, const gbsize_t members, gbfile* self)
 static gbsize_t
 gzapi_write(const void* buf, const gbsize_t size, const gbsize_t members, gbfile* self)
 {
-  return gzwrite(self->handle.gz, buf, size * members) / size;
+  qint64 result = self->handle.gz->writer->write((const char*) buf, static_cast<qint64>(size) * members);
+  return (result < 0) ? 0 : (gbsize_t)(result / size);
 }
 
 static int
 gzapi_flush(gbfile* self)
 {
-  return gzflush(self->handle.gz, Z_SYNC_FLUSH);
+  gbgzfile* gz = self->handle.gz;
+  if (gz->writer) {
+    if (!gz->writer->flush()) {
+      gbFatal("Could not write to %s (%s)!\n",
+            gbLogCStr(self->name), gbLogCStr(gz->writer->errorString()));
+    }
+    if (!gz->file.flush()) {
+      gbFatal("Could not write to %s (%s)!\n",
+            gbLogCStr(self->name), gbLogCStr(gz->file.errorString()));
+    }
+  }
+  return 0;
 }
 
-static gbsize_t
+static gbfoff_t
 gzapi_tell(gbfile* self)
 {
-  gbsize_t result = gztell(self->handle.gz);
+  gbgzfile* gz = self->handle.gz;
+  gbfoff_t result;
+  if (gz->reader) {
+    result = gz->reader->pos();
+  } else if (gz->writer) {
+    result = gz->writer->pos();
+  } else {
+    result = gz->file.pos();
+  }
   if (self->back != -1) {
     result--;
   }
@@ -200,31 +292,14 @@ gzapi_tell(gbfile* self)
 static int
 gzapi_eof(gbfile* self)
 {
-  int res = 0;
-
   if (self->back != -1) {
-    return res;
+    return 0;
   }
-
-  res  = gzeof(self->handle.gz);
-  if (!res) {
-    unsigned char test;
-    int len = gzread(self->handle.gz, &test, 1);
-    if (len == 1) {
-      /* No EOF, put the single byte back into stream */
-      self->back = test;
-    } else {
-      /* we are at the end of the file */
-      if (global_opts.debug_level > 0) {
-        /* now gzeof() should return 1 */
-        if (!gzeof(self->handle.gz)) {
-          gbFatal("zlib gzeof error!\n");
-        }
-      }
-      res = 1;
-    }
+  gbgzfile* gz = self->handle.gz;
+  if (gz->reader) {
+    return gz->reader->atEnd() ? 1 : 0;
   }
-  return res;
+  return gz->file.atEnd() ? 1 : 0;
 }
 
 static int
@@ -241,17 +316,21 @@ gzapi_ungetc(const int c, gbfile* self)
 static void
 gzapi_clearerr(gbfile* self)
 {
-  gzclearerr(self->handle.gz);
+  /* Stream errors are sticky, and the end of file is not a state here. */
+  (void)self;
 }
 
 static int
 gzapi_error(gbfile* self)
 {
-  int errnum;
-
-  (void)gzerror(self->handle.gz, &errnum);
-
-  return errnum;
+  gbgzfile* gz = self->handle.gz;
+  if (gz->reader) {
+    return gz->reader->error();
+  }
+  if (gz->writer) {
+    return gz->writer->error();
+  }
+  return (gz->file.error() == QFileDevice::NoError) ? Z_OK : Z_ERRNO;
 }
 #endif	// #if !ZLIB_INHIBITED
 
@@ -274,15 +353,15 @@ stdapi_close(gbfile* self)
 }
 
 static int
-stdapi_seek(gbfile* self, int32_t offset, int whence)
+stdapi_seek(gbfile* self, gbfoff_t offset, int whence)
 {
-  gbsize_t pos = 0;
+  gbfoff_t pos = 0;
 
   if (whence != SEEK_SET) {
-    pos = ftell(self->handle.std);
+    pos = gb_ftell(self->handle.std);
   }
 
-  int result = fseek(self->handle.std, offset, whence);
+  int result = gb_fseek(self->handle.std, offset, whence);
   if (result != 0) {
     switch (whence) {
     case SEEK_CUR:
@@ -296,8 +375,8 @@ stdapi_seek(gbfile* self, int32_t offset, int whence)
       gbFatal("Unknown seek operation (%d) for file %s!\n",
             whence, gbLogCStr(self->name));
     }
-    gbFatal("Unable to set file (%s) to position (%llu)!\n",
-          gbLogCStr(self->name), (long long unsigned) pos);
+    gbFatal("Unable to set file (%s) to position (%lld)!\n",
+          gbLogCStr(self->name), static_cast<long long>(pos));
   }
   return 0;
 }
@@ -327,10 +406,10 @@ stdapi_flush(gbfile* self)
   return fflush(self->handle.std);
 }
 
-static gbsize_t
+static gbfoff_t
 stdapi_tell(gbfile* self)
 {
-  return ftell(self->handle.std);
+  return gb_ftell(self->handle.std);
 }
 
 static int
@@ -385,9 +464,9 @@ memapi_close(gbfile* self)
 }
 
 static int
-memapi_seek(gbfile* self, int32_t offset, int whence)
+memapi_seek(gbfile* self, gbfoff_t offset, int whence)
 {
-  long long pos = (int)self->mempos;
+  gbfoff_t pos = self->mempos;
 
   switch (whence) {
   case SEEK_CUR:
@@ -410,12 +489,9 @@ memapi_seek(gbfile* self, int32_t offset, int whence)
 static gbsize_t
 memapi_read(void* buf, const gbsize_t size, const gbsize_t members, gbfile* self)
 {
-  gbsize_t result = (self->memlen - self->mempos) / size;
-
-  if (result > members) {
-    result = members;
-  }
-  gbsize_t count = result * size;
+  gbfoff_t avail = (self->memlen - self->mempos) / size;
+  gbsize_t result = (avail > members) ? members : static_cast<gbsize_t>(avail);
+  gbfoff_t count = static_cast<gbfoff_t>(result) * size;
   if (count) {
     memcpy(buf, self->handle.mem + self->mempos, count);
     self->mempos += count;
@@ -432,7 +508,7 @@ memapi_write(const void* buf, const gbsize_t size, const gbsize_t members, gbfil
     return 0;
   }
 
-  gbsize_t count = size * members;
+  gbfoff_t count = static_cast<gbfoff_t>(size) * members;
 
   if (self->mempos + count > self->memsz) {
     self->memsz = ((self->mempos + count + 4095) / 4096) * 4096;
@@ -454,7 +530,7 @@ memapi_flush(gbfile* self)
   return 0;
 }
 
-static gbsize_t
+static gbfoff_t
 memapi_tell(gbfile* self)
 {
   return self->mempos;
@@ -863,7 +939,7 @@ gbfrewind(gbfile* file)
  */
 
 int
-gbfseek(gbfile* file, int32_t offset, int whence)
+gbfseek(gbfile* file, gbfoff_t offset, int whence)
 {
   return file->fileseek(file, offset, whence);
 }
@@ -872,11 +948,11 @@ gbfseek(gbfile* file, int32_t offset, int whence)
  * gbftell: (as ftell)
  */
 
-gbsize_t
+gbfoff_t
 gbftell(gbfile* file)
 {
-  gbsize_t result = file->filetell(file);
-  if ((signed) result == -1)
+  gbfoff_t result = file->filetell(file);
+  if (result < 0)
     gbFatal("Could not determine position of file '%s'!\n",
           gbLogCStr(file->name));
   return result;
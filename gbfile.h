@@ -26,7 +26,7 @@
 #include <QByteArray>           // for QByteArray
 #include <QString>              // for QString
 
-#include <cstdint>             // for int32_t, int16_t, uint32_t
+#include <cstdint>             // for int32_t, int16_t, uint32_t, int64_t
 #include <cstdio>              // for FILE
 
 #if HAVE_LIBZ
@@ -37,7 +37,9 @@
 
 
 struct gbfile;
-using gbsize_t = uint32_t;
+struct gbgzfile;
+using gbsize_t = uint32_t;	/* size and count of a single read or write */
+using gbfoff_t = int64_t;	/* file position, may exceed 4 GiB */
 
 using gbfclearerr_cb = void (*)(gbfile* self);
 using gbfclose_cb = int (*)(gbfile* self);
@@ -46,8 +48,8 @@ using gbferror_cb = int (*)(gbfile* self);
 using gbfflush_cb = int (*)(gbfile* self);
 using gbfopen_cb = gbfile* (*)(gbfile* self, const char* mode);
 using gbfread_cb = gbsize_t (*)(void* buf, const gbsize_t size, const gbsize_t members, gbfile* self);
-using gbfseek_cb = int (*)(gbfile* self, int32_t offset, int whence);
-using gbftell_cb = gbsize_t (*)(gbfile* self);
+using gbfseek_cb = int (*)(gbfile* self, gbfoff_t offset, int whence);
+using gbftell_cb = gbfoff_t (*)(gbfile* self);
 using gbfwrite_cb = gbsize_t (*)(const void* buf, const gbsize_t size, const gbsize_t members, gbfile* self);
 using gbfungetc_cb = int (*)(const int c, gbfile* self);
 
@@ -56,7 +58,7 @@ struct gbfile {
     FILE* std;
     unsigned char* mem;
 #if !ZLIB_INHIBITED
-    gzFile gz;
+    gbgzfile* gz;
 #endif
   } handle{nullptr};
   QString   name;
@@ -64,9 +66,9 @@ struct gbfile {
   int    buffsz{0};
   char   mode{0};
   int    back{0};
-  gbsize_t mempos{0};	/* curr. position in memory */
-  gbsize_t memlen{0};	/* max. number of written bytes to memory */
-  gbsize_t memsz{0};	/* curr. size of allocated memory */
+  gbfoff_t mempos{0};	/* curr. position in memory */
+  gbfoff_t memlen{0};	/* max. number of written bytes to memory */
+  gbfoff_t memsz{0};	/* curr. size of allocated memory */
   unsigned char big_endian:1{0};
   unsigned char binary:1{0};
   unsigned char gzapi:1{0};
@@ -113,8 +115,8 @@ int gbfflush(gbfile* file);
 void gbfclearerr(gbfile* file);
 int gbferror(gbfile* file);
 void gbfrewind(gbfile* file);
-int gbfseek(gbfile* file, int32_t offset, int whence);
-gbsize_t gbftell(gbfile* file);
+int gbfseek(gbfile* file, gbfoff_t offset, int whence);
+gbfoff_t gbftell(gbfile* file);
 int gbfeof(gbfile* file);
 int gbfungetc(int c, gbfile* file);
 
@@ -26,6 +26,7 @@
 #include <cassert>
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
 
 void gbser_db(int l, const char* msg, ...)
 {
@@ -92,6 +93,39 @@ int gbser_read_wait(void* handle, void* buf, unsigned len, unsigned ms)
   return got;
 }
 
+/* Wait up to |ms| milliseconds until at least |want| bytes can be read
+ * without blocking, or, if |eol| isn't negative, until a byte equal to
+ * |eol| can. Nothing is consumed.
+ */
+int gbser_wait(void* handle, unsigned want, int eol, unsigned ms)
+{
+  unsigned scanned = 0;
+
+  for (;;) {
+    const unsigned char* data;
+    unsigned avail = gbser_peek_buffer(handle, &data);
+    if (avail >= want) {
+      return avail;
+    }
+    if (eol >= 0 && memchr(data + scanned, eol, avail - scanned) != nullptr) {
+      return avail;
+    }
+    scanned = avail;
+
+    if (ms == 0) {
+      return gbser_TIMEOUT;
+    }
+    int rc = gbser_fill_buffer(handle, avail + 1, &ms);
+    if (rc < 0) {
+      return rc;
+    }
+    if ((unsigned) rc == avail && ms != 0) {
+      /* The buffer is full, there is no more to wait for. */
+      return avail;
+    }
+  }
+}
+
 /* Read a single character from the port, returning immediately if
  * none are available.
  */
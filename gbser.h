@@ -71,6 +71,13 @@ int gbser_read(void* handle, void* buf, unsigned len);
  */
 int gbser_read_wait(void* handle, void* buf, unsigned len, unsigned ms);
 
+/* Wait up to |ms| milliseconds until at least |want| bytes can be read
+ * without blocking, or, if |eol| isn't negative, until a byte equal to
+ * |eol| can. Nothing is consumed. Returns the number of bytes available,
+ * gbser_TIMEOUT or gbser_ERROR.
+ */
+int gbser_wait(void* handle, unsigned want, int eol, unsigned ms);
+
 /* Read from the serial port until the specified |eol| character is
  * found. Any character matching |discard| will be discarded. To
  * read lines terminated by 0x0A0x0D discarding linefeeds use
@@ -25,13 +25,21 @@
 
 #include <cassert>
 #include <cerrno>
+#include <cmath>
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
 #include <fcntl.h>
+#include <poll.h>
 #include <sys/time.h>
 #include <termios.h>
 #include <unistd.h>
 
+/* Big enough to hold everything a device sends at 230400bps while we
+ * are busy elsewhere for half a second.
+ */
+#define INBUFSIZE 16384
+
 struct gbser_handle {
   struct termios  old_tio;
   struct termios  new_tio;
@@ -39,7 +47,9 @@ struct gbser_handle {
   unsigned        vmin, vtime;
   unsigned long   magic;
 
-  unsigned char   inbuf[BUFSIZE];
+  /* Buffered input is inbuf[inbuf_head .. inbuf_head + inbuf_used). */
+  unsigned char   inbuf[INBUFSIZE];
+  unsigned        inbuf_head;
   unsigned        inbuf_used;
 };
 
@@ -104,24 +114,46 @@ static double elapsed(hp_time* tv)
   return nt - ot;
 }
 
-static int set_rx_timeout(gbser_handle* h, unsigned vmin, unsigned vtime)
+/* Read whatever the port has for us into the free space of the input
+ * buffer.  The port is set up with VMIN = VTIME = 0, so this doesn't
+ * block.  Returns the number of bytes read or gbser_ERROR.
+ */
+static int read_available(gbser_handle* h)
 {
-  if (vmin  > 255) {
-    vmin  = 255;
+  if (h->inbuf_used == 0) {
+    h->inbuf_head = 0;
+  } else if (h->inbuf_head + h->inbuf_used == sizeof(h->inbuf)) {
+    memmove(h->inbuf, h->inbuf + h->inbuf_head, h->inbuf_used);
+    h->inbuf_head = 0;
   }
-  if (vtime > 255) {
-    vtime = 255;
-  }
-  if (vmin != h->vmin || vtime != h->vtime) {
-    h->vmin  = h->new_tio.c_cc[VMIN]  = vmin;
-    h->vtime = h->new_tio.c_cc[VTIME] = vtime;
 
-    /*printf("VMIN=%d, VTIME=%d\n", h->vmin, h->vtime);*/
+  unsigned tail = h->inbuf_head + h->inbuf_used;
+  ssize_t rc = read(h->fd, h->inbuf + tail, sizeof(h->inbuf) - tail);
+  if (rc < 0) {
+    return (errno == EAGAIN || errno == EINTR) ? 0 : gbser_ERROR;
+  }
+  h->inbuf_used += rc;
+  return rc;
+}
 
-    return tcsetattr(h->fd, TCSANOW, &h->new_tio) ? gbser_ERROR : gbser_OK;
-  } else {
-    return 0;
+/* Wait up to |ms| milliseconds for the port to become readable.
+ * Returns 1 if it is, 0 on timeout or gbser_ERROR.
+ */
+static int wait_readable(gbser_handle* h, int ms)
+{
+  struct pollfd pfd;
+  pfd.fd = h->fd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+
+  int rc = poll(&pfd, 1, ms);
+  if (rc < 0) {
+    return errno == EINTR ? 0 : gbser_ERROR;
   }
+  if (pfd.revents & POLLNVAL) {
+    return gbser_ERROR;
+  }
+  return rc > 0;
 }
 
 /* Open a serial port. |port_name| is the (platform specific) name
@@ -260,9 +292,8 @@ unsigned gbser_read_buffer(void* handle, void** buf, unsigned* len)
     count = h->inbuf_used;
   }
 
-  memcpy(cp, h->inbuf, count);
-  memmove(h->inbuf, h->inbuf + count,
-          h->inbuf_used - count);
+  memcpy(cp, h->inbuf + h->inbuf_head, count);
+  h->inbuf_head += count;
   h->inbuf_used -= count;
   *len -= count;
   cp   += count;
@@ -270,19 +301,28 @@ unsigned gbser_read_buffer(void* handle, void** buf, unsigned* len)
   return count;
 }
 
+unsigned gbser_peek_buffer(void* handle, const unsigned char** data)
+{
+  gbser_handle* h = gbser_get_handle(handle);
+  *data = h->inbuf + h->inbuf_head;
+  return h->inbuf_used;
+}
+
 /* Return when the input buffer contains at least |want| bytes or |*ms|
  * milliseconds have elapsed. |ms| may be NULL or |*ms| may be zero to
  * poll the port for available bytes and return immediately. |*ms| will
  * be updated to indicate the remaining time on exit.
  * Returns the number of bytes available (>=0) or an error code (<0).
+ *
+ * Every read takes all the port has, not just |want| bytes, so callers
+ * reading a byte at a time are mostly served from the buffer.
  */
 int gbser_fill_buffer(void* handle, unsigned want, unsigned* ms)
 {
-  int rc;
   gbser_handle* h = gbser_get_handle(handle);
 
-  if (want > BUFSIZE) {
-    want = BUFSIZE;
+  if (want > sizeof(h->inbuf)) {
+    want = sizeof(h->inbuf);
   }
 
   /* Already got enough bytes? */
@@ -291,67 +331,34 @@ int gbser_fill_buffer(void* handle, unsigned want, unsigned* ms)
   }
 
   if (nullptr == ms || 0 == *ms) {
-    if ((rc = set_rx_timeout(h, 0, 0), rc < 0) ||
-        (rc = read(h->fd, h->inbuf + h->inbuf_used,
-                   want - h->inbuf_used), rc < 0)) {
+    int rc = wait_readable(h, 0);
+    if (rc > 0) {
+      rc = read_available(h);
+    }
+    if (rc < 0) {
       return gbser_ERROR;
     }
-    h->inbuf_used += rc;
-    /*printf("Got %d bytes\n", rc);*/
   } else {
     double time_left = *ms;
     hp_time tv;
     get_time(&tv);
 
-    for (;;) {
-      fd_set rec;
-      struct timeval t;
-
+    while (h->inbuf_used < want) {
       time_left = *ms - elapsed(&tv);
-      if (time_left <= 0 || h->inbuf_used >= want) {
+      if (time_left <= 0) {
         break;
       }
 
-      FD_ZERO(&rec);
-      FD_SET(h->fd, &rec);
-
-      t.tv_sec  = (time_t) time_left / 1000;
-      t.tv_usec = ((unsigned) time_left % 1000) * 1000;
-
-      if (select(h->fd + 1, &rec, nullptr, nullptr, &t) < 0) {
-        return gbser_ERROR;
+      int rc = wait_readable(h, (int) ceil(time_left));
+      if (rc > 0) {
+        rc = read_available(h);
       }
-
-      time_left = *ms - elapsed(&tv);
-
-      if (FD_ISSET(h->fd, &rec)) {
-#if 0
-        // See below comment.
-
-        unsigned vmin = 0, vtime = 0;
-        if (time_left >= 100) {
-          vmin  = want - h->inbuf_used;
-          vtime = (unsigned) time_left / 100;
-        }
-#endif
-        // The commented out call to set_rx_timeout here is totally
-        // legal by POSIX standards but does result in a flurry of
-        // of tcsetattrs that slightly tweak VMIN/VTIME while there
-        // is incoming data.   This has been shown to trigger driver
-        // bugs in the Prolific drivers for Mac and in certain Linux
-        // kernels, thought the latter has since been fixed.
-        // So although removing this means that the timeout behaviour
-        // is actually different on POSIX and WIN32, it triggers
-        // fewer buts this way.  2/12/2008 RJL
-        if (/* (rc = set_rx_timeout(h, vmin, vtime), rc < 0) || */
-          (rc = read(h->fd, h->inbuf + h->inbuf_used,
-                     want - h->inbuf_used), rc < 0)) {
-          return gbser_ERROR;
-        }
-        h->inbuf_used += rc;
-        /*printf("Got %d bytes\n", rc);*/
+      if (rc < 0) {
+        return gbser_ERROR;
       }
     }
+
+    time_left = *ms - elapsed(&tv);
     *ms = (time_left < 0) ? 0 : time_left;
   }
 
@@ -363,7 +370,7 @@ int gbser_fill_buffer(void* handle, unsigned want, unsigned* ms)
 int gbser_flush(void* handle)
 {
   gbser_handle* h = gbser_get_handle(handle);
-  h->inbuf_used = 0;
+  h->inbuf_head = h->inbuf_used = 0;
   if (tcflush(h->fd, TCIFLUSH)) {
     return gbser_ERROR;
   }
@@ -447,27 +454,29 @@ const char* fix_win_serial_name(const char* comname)
  */
 int gbser_read_line(void* handle, void* buf, unsigned len, unsigned ms, int eol, int discard)
 {
+  gbser_handle* h = gbser_get_handle(handle);
   char* bp = (char*) buf;
   unsigned pos = 0;
-  hp_time tv;
-  get_time(&tv);
   bp[pos] = '\0';
   for (;;) {
-    signed time_left = ms - elapsed(&tv);
-    int c;
+    /* Take everything that is buffered, then wait for more. */
+    while (h->inbuf_used > 0) {
+      int c = h->inbuf[h->inbuf_head++];
+      h->inbuf_used--;
+      if (c == eol) {
+        return gbser_OK;
+      }
+      if (c != discard && pos < len - 1) {
+        bp[pos++] = c;
+        bp[pos]   = '\0';
+      }
+    }
 
-    if (time_left <= 0) {
+    if (ms == 0) {
       return gbser_TIMEOUT;
     }
-    c = gbser_readc_wait(handle, time_left);
-    if (c == gbser_ERROR) {
-      return c;
-    } else if (c == eol) {
-      return gbser_OK;
-    }
-    if (c != gbser_NOTHING && c != discard && pos < len - 1) {
-      bp[pos++] = c;
-      bp[pos]   = '\0';
+    if (gbser_fill_buffer(handle, 1, &ms) < 0) {
+      return gbser_ERROR;
     }
   }
 }
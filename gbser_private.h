@@ -27,4 +27,5 @@
 [[gnu::format(printf, 2, 3)]] void gbser_db(int l, const char* msg, ...);
 int gbser_fill_buffer(void* handle, unsigned want, unsigned* ms);
 unsigned gbser_read_buffer(void* handle, void** buf, unsigned* len);
+unsigned gbser_peek_buffer(void* handle, const unsigned char** data);
 #endif // GBSER_PRIVATE_H_
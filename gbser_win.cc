@@ -285,6 +285,13 @@ unsigned gbser_read_buffer(void* handle, void** buf, unsigned* len)
   return count;
 }
 
+unsigned gbser_peek_buffer(void* handle, const unsigned char** data)
+{
+  gbser_handle* h = gbser_get_handle(handle);
+  *data = h->inbuf;
+  return h->inbuf_used;
+}
+
 /* Return when the input buffer contains at least |want| bytes or |*ms|
  * milliseconds have elapsed. |ms| may be NULL or |*ms| may be zero to
  * poll the port for available bytes and return immediately. |*ms| will
@@ -34,6 +34,7 @@
 #include <Qt>                       // for CaseInsensitive
 #include <QtGlobal>                 // for Q_UNUSED, qPrintable, foreach
 
+#include <algorithm>                // for min
 #include <cmath>                    // for fabs
 #include <cstdio>                   // for SEEK_SET
 #include <cstring>                  // for memset, strstr, strcmp
@@ -883,6 +884,7 @@ GdbFormat::read_track()
   res->line_color.bbggrr = gt_color_value(color_idx);
 
   int points = FREAD_i32;
+  res->waypoint_list.reserve(std::min(points, kMaxReserve));
 
   for (int index = 0; index < points; index++) {
     auto* wpt = new Waypoint;
@@ -1025,7 +1027,7 @@ GdbFormat::read()
       break;
     }
 
-    int delta = len - gbftell(ftmp);
+    int delta = len - static_cast<int>(gbftell(ftmp));
     if (delta > 1000000) {
       gbFatal("Internal consistency error.  Delta too big\n");
     }
@@ -1465,7 +1467,7 @@ GdbFormat::write_track(const route_head* trk, const QString& trk_name)
 void
 GdbFormat::finalize_item(gbfile* origin, const char identifier)
 {
-  int len = gbftell(fout);
+  int len = static_cast<int>(gbftell(fout));	/* size of the record in the memory stream */
 
   fout = origin;
   gbfseek(ftmp, 0, SEEK_SET);
@@ -86,7 +86,7 @@ void GeoFormat::read()
 {
   gpsbabel::File ifile = gpsbabel::File(fname);
   ifile.open(QIODevice::ReadOnly);
-  QXmlStreamReader reader = QXmlStreamReader(&ifile);
+  QXmlStreamReader reader = QXmlStreamReader(ifile.device());
 
   GeoReadLoc(reader);
   if (reader.hasError())  {
@@ -201,7 +201,7 @@ void GeoFormat::write()
 {
   gpsbabel::File ofile = gpsbabel::File(fname);
   ofile.open(QIODevice::WriteOnly | QIODevice::Text);
-  QXmlStreamWriter writer = QXmlStreamWriter(&ofile);
+  QXmlStreamWriter writer = QXmlStreamWriter(ofile.device());
 
   writer.setAutoFormatting(true);
   writer.setAutoFormattingIndent(0);
@@ -17,18 +17,21 @@
 
  */
 
+#include <utility>                 // for as_const
+
 #include <QByteArray>              // for QByteArray
 #include <QIODevice>               // for operator|, QIODevice, QIODevice::ReadOnly, QIODevice::Text
 #include <QJsonArray>              // for QJsonArray
-#include <QJsonDocument>           // for QJsonDocument, QJsonDocument::Compact, QJsonDocument::Indented, QJsonDocument::JsonFormat
 #include <QJsonObject>             // for QJsonObject
-#include <QJsonParseError>         // for QJsonParseError
 #include <QJsonValue>              // for QJsonValue
 #include <QJsonValueRef>           // for QJsonValueRef
+#include <QMap>                    // for QMap
 
 #include "defs.h"
 #include "geojson.h"
 #include "src/core/file.h"         // for File
+#include "src/core/jsonstreamreader.h"  // for JsonStreamReader
+#include "src/core/jsonstreamwriter.h"  // for JsonStreamWriter
 #include "src/core/logging.h"      // for Fatal
 
 
@@ -39,33 +42,70 @@ GeoJsonFormat::rd_init(const QString& fname)
   ifd->open(QIODevice::ReadOnly | QIODevice::Text);
 }
 
+/*
+ * Features are written as they come, so nothing is held in memory but
+ * the writer's buffer.  Members are written in key order, which is how
+ * QJsonDocument, and so our earlier output, had them.  With seq every
+ * feature goes on a line of its own with no FeatureCollection around
+ * them, as in GeoJSONSeq.
+ */
 void
 GeoJsonFormat::wr_init(const QString& fname)
 {
-  feature_collection = new QJsonArray;
   ofd = new gpsbabel::File(fname);
   ofd->open(QIODevice::WriteOnly);
+  gpsbabel::JsonStreamWriter::Style style = gpsbabel::JsonStreamWriter::Style::Indented;
+  if (seq_opt) {
+    style = gpsbabel::JsonStreamWriter::Style::Lines;
+  } else if (compact_opt) {
+    style = gpsbabel::JsonStreamWriter::Style::Compact;
+  }
+  writer = new gpsbabel::JsonStreamWriter(ofd->device(), style);
+  if (!seq_opt) {
+    writer->writeStartObject();
+    writer->writeName(FEATURES);
+    writer->writeStartArray();
+  }
 }
 
 void
-GeoJsonFormat::geojson_waypt_pr(const Waypoint* waypoint) const
+GeoJsonFormat::geojson_coordinates(const Waypoint* waypoint) const
 {
-  QJsonObject geometry;
-  geometry[TYPE] = POINT;
-  QJsonArray coordinates;
-  coordinates.append(waypoint->longitude);
-  coordinates.append(waypoint->latitude);
+  writer->writeStartArray();
+  writer->writeDouble(waypoint->longitude);
+  writer->writeDouble(waypoint->latitude);
   if (waypoint->altitude != unknown_alt && waypoint->altitude != 0) {
-    coordinates.append(waypoint->altitude);
+    writer->writeDouble(waypoint->altitude);
   }
-  geometry[COORDINATES] = coordinates;
+  writer->writeEndArray();
+}
 
-  QJsonObject feature;
-  feature[TYPE] = FEATURE;
-  feature[GEOMETRY] = geometry;
+void
+GeoJsonFormat::geojson_properties(const QMap<QString, QString>& properties) const
+{
+  writer->writeName(PROPERTIES);
+  writer->writeStartObject();
+  for (auto it = properties.cbegin(); it != properties.cend(); ++it) {
+    writer->writeName(it.key());
+    writer->writeString(it.value());
+  }
+  writer->writeEndObject();
+}
+
+void
+GeoJsonFormat::geojson_waypt_pr(const Waypoint* waypoint) const
+{
+  writer->writeStartObject();
+  writer->writeName(GEOMETRY);
+  writer->writeStartObject();
+  writer->writeName(COORDINATES);
+  geojson_coordinates(waypoint);
+  writer->writeName(TYPE);
+  writer->writeString(POINT);
+  writer->writeEndObject();
 
   // Build up the properties.
-  QJsonObject properties;
+  QMap<QString, QString> properties;
   if (!waypoint->shortname.isEmpty()) {
     properties[name_opt] = waypoint->shortname;
   }
@@ -82,10 +122,12 @@ GeoJsonFormat::geojson_waypt_pr(const Waypoint* waypoint) const
     }
   }
   if (!properties.empty()) {
-    feature[PROPERTIES] = properties;
+    geojson_properties(properties);
   }
 
-  feature_collection->append(feature);
+  writer->writeName(TYPE);
+  writer->writeString(FEATURE);
+  writer->writeEndObject();
 }
 
 void
@@ -99,19 +141,18 @@ GeoJsonFormat::rd_deinit()
 void
 GeoJsonFormat::wr_deinit()
 {
-  QJsonObject object;
-  object[TYPE] = FEATURE_COLLECTION;
-  object[FEATURES]  = *feature_collection;
+  if (!seq_opt) {
+    writer->writeEndArray();
+    writer->writeName(TYPE);
+    writer->writeString(FEATURE_COLLECTION);
+    writer->writeEndObject();
+  }
+  delete writer;
+  writer = nullptr;
 
-  QJsonDocument save(object);
-  QJsonDocument::JsonFormat style = compact_opt ? QJsonDocument::Compact : QJsonDocument::Indented;
-  ofd->write(save.toJson(style));
   ofd->close();
-
   delete ofd;
   ofd = nullptr;
-  delete feature_collection;
-  feature_collection = nullptr;
 }
 
 Waypoint*
@@ -141,129 +182,168 @@ GeoJsonFormat::routes_from_polygon_coordinates(const QJsonArray& polygon)
 }
 
 void
-GeoJsonFormat::read()
+GeoJsonFormat::read_feature(const QJsonObject& feature)
 {
-  QString file_content = ifd->readAll();
-  QJsonParseError error{};
-  QJsonDocument document = QJsonDocument::fromJson(file_content.toUtf8(), &error);
-  if (error.error != QJsonParseError::NoError) {
-    gbFatal(FatalMsg().nospace() << "GeoJSON parse error in " << ifd->fileName() << ": " << error.errorString());
+  QJsonObject properties = (feature.value(PROPERTIES)).toObject();
+  QString name;
+  QString description;
+  if (!properties.empty()) {
+    if (properties.contains(name_opt)) {
+      name = properties[name_opt].toString();
+    }
+    if (properties.contains(desc_opt)) {
+      description = properties[desc_opt].toString();
+    }
   }
-  QJsonObject rootObject = document.object();
 
-  if (rootObject[TYPE] != FEATURE_COLLECTION) {
-    return;
-  }
-  QJsonArray features = rootObject.value(FEATURES).toArray();
-  for (auto&& iterator : features) {
-    QJsonObject feature = iterator.toObject();
-    QJsonObject properties = (feature.value(PROPERTIES)).toObject();
-    QString name;
-    QString description;
-    if (!properties.empty()) {
-      if (properties.contains(name_opt)) {
-        name = properties[name_opt].toString();
-      }
-      if (properties.contains(desc_opt)) {
-        description = properties[desc_opt].toString();
+  QJsonObject geometry = feature.value(GEOMETRY).toObject();
+  auto geometry_type = geometry[TYPE];
+  if (geometry_type == POINT) {
+    QJsonArray coordinates = geometry.value(COORDINATES).toArray();
+    auto* waypoint = waypoint_from_coordinates(coordinates);
+    waypoint->shortname = name;
+    waypoint->description = description;
+    if (properties.contains(URL)) {
+      QString url = properties[URL].toString();
+      if (properties.contains(URLNAME)) {
+        QString url_text = properties[URLNAME].toString();
+        waypoint->AddUrlLink(UrlLink(url, url_text));
+      } else {
+        waypoint->AddUrlLink(UrlLink(url));
       }
     }
-
-    QJsonObject geometry = feature.value(GEOMETRY).toObject();
-    auto geometry_type = geometry[TYPE];
-    if (geometry_type == POINT) {
-      QJsonArray coordinates = geometry.value(COORDINATES).toArray();
-      auto* waypoint = waypoint_from_coordinates(coordinates);
-      waypoint->shortname = name;
-      waypoint->description = description;
-      if (properties.contains(URL)) {
-        QString url = properties[URL].toString();
-        if (properties.contains(URLNAME)) {
-          QString url_text = properties[URLNAME].toString();
-          waypoint->AddUrlLink(UrlLink(url, url_text));
-        } else {
-          waypoint->AddUrlLink(UrlLink(url));
-        }
-      }
+    waypt_add(waypoint);
+  } else if (geometry_type == MULTIPOINT) {
+    QJsonArray coordinates = geometry.value(COORDINATES).toArray();
+    for (auto&& coordinate : coordinates) {
+      auto* waypoint = waypoint_from_coordinates(coordinate.toArray());
       waypt_add(waypoint);
-    } else if (geometry_type == MULTIPOINT) {
-      QJsonArray coordinates = geometry.value(COORDINATES).toArray();
-      for (auto&& coordinate : coordinates) {
-        auto* waypoint = waypoint_from_coordinates(coordinate.toArray());
-        waypt_add(waypoint);
-      }
-    } else if (geometry_type == LINESTRING) {
-      QJsonArray coordinates = geometry.value(COORDINATES).toArray();
+    }
+  } else if (geometry_type == LINESTRING) {
+    QJsonArray coordinates = geometry.value(COORDINATES).toArray();
+    auto* route = new route_head;
+    route->rte_name = name;
+    route_add_head(route);
+    for (auto&& coordinate : coordinates) {
+      auto* waypoint = waypoint_from_coordinates(coordinate.toArray());
+      route_add_wpt(route, waypoint);
+    }
+  } else if (geometry_type == POLYGON) {
+    QJsonArray polygon = geometry.value(COORDINATES).toArray();
+    routes_from_polygon_coordinates(polygon);
+  } else if (geometry_type == MULTIPOLYGON) {
+    QJsonArray polygons = geometry.value(COORDINATES).toArray();
+    for (auto&& polygons_iterator : polygons) {
+      QJsonArray polygon = polygons_iterator.toArray();
+      routes_from_polygon_coordinates(polygon);
+    }
+  } else if (geometry_type == MULTILINESTRING) {
+    QJsonArray line_strings = geometry.value(COORDINATES).toArray();
+    for (auto&& line_string : line_strings) {
+      QJsonArray coordinates = line_string.toArray();
       auto* route = new route_head;
       route->rte_name = name;
-      route_add_head(route);
+      track_add_head(route);
       for (auto&& coordinate : coordinates) {
         auto* waypoint = waypoint_from_coordinates(coordinate.toArray());
         route_add_wpt(route, waypoint);
       }
-    } else if (geometry_type == POLYGON) {
-      QJsonArray polygon = geometry.value(COORDINATES).toArray();
-      routes_from_polygon_coordinates(polygon);
-    } else if (geometry_type == MULTIPOLYGON) {
-      QJsonArray polygons = geometry.value(COORDINATES).toArray();
-      for (auto&& polygons_iterator : polygons) {
-        QJsonArray polygon = polygons_iterator.toArray();
-        routes_from_polygon_coordinates(polygon);
-      }
-    } else if (geometry_type == MULTILINESTRING) {
-      QJsonArray line_strings = geometry.value(COORDINATES).toArray();
-      for (auto&& line_string : line_strings) {
-        QJsonArray coordinates = line_string.toArray();
-        auto* route = new route_head;
-        route->rte_name = name;
-        track_add_head(route);
-        for (auto&& coordinate : coordinates) {
-          auto* waypoint = waypoint_from_coordinates(coordinate.toArray());
-          route_add_wpt(route, waypoint);
+    }
+  }
+}
+
+void
+GeoJsonFormat::read()
+{
+  /*
+   * Features are parsed and converted one at a time, so memory use
+   * follows the largest feature rather than the file.  Only when the
+   * features come before the type of the root object do we have to
+   * hold on to them until we know what we are reading.
+   */
+  gpsbabel::JsonStreamReader reader(ifd->device());
+  auto check = [this, &reader]()->void {
+    if (reader.hasError()) {
+      gbFatal(FatalMsg().nospace() << "GeoJSON parse error in " << ifd->fileName() << ": " << reader.errorString());
+    }
+  };
+
+  bool type_seen = false;
+  bool feature_collection_seen = false;
+  QJsonArray pending;
+  if (reader.readNext() == gpsbabel::JsonStreamReader::StartObject) {
+    while (reader.readNext() == gpsbabel::JsonStreamReader::Name) {
+      const QString key = reader.name();
+      reader.readNext();
+      if (key == TYPE) {
+        type_seen = true;
+        feature_collection_seen = reader.readValue() == FEATURE_COLLECTION;
+        check();
+        if (feature_collection_seen) {
+          for (auto&& feature : std::as_const(pending)) {
+            read_feature(feature.toObject());
+          }
+        }
+        pending = QJsonArray();
+      } else if ((key == FEATURES) &&
+                 (reader.tokenType() == gpsbabel::JsonStreamReader::StartArray) &&
+                 (!type_seen || feature_collection_seen)) {
+        while (reader.readNext() != gpsbabel::JsonStreamReader::EndArray) {
+          if (reader.tokenType() == gpsbabel::JsonStreamReader::StartObject) {
+            QJsonValue feature = reader.readValue();
+            check();
+            if (type_seen) {
+              read_feature(feature.toObject());
+            } else {
+              pending.append(feature);
+            }
+          } else {
+            reader.skipValue();
+            check();
+          }
         }
+      } else {
+        reader.skipValue();
       }
     }
+  } else {
+    reader.skipValue();
   }
+  reader.readNext();
+  check();
 }
 
 
-void GeoJsonFormat::geojson_track_hdr(const route_head* track)
+void GeoJsonFormat::geojson_track_hdr(const route_head* /*unused*/)
 {
-  track_object = new QJsonObject();
-
-  (*track_object)[TYPE] = FEATURE;
-  track_coords = new QJsonArray();
-
-  QJsonObject properties;
-  if (!track->rte_name.isEmpty()) {
-    properties[name_opt] = track->rte_name;
-  }
-  (*track_object)[PROPERTIES] = properties;
+  writer->writeStartObject();
+  writer->writeName(GEOMETRY);
+  writer->writeStartObject();
+  writer->writeName(COORDINATES);
+  writer->writeStartArray();
 }
 
 void GeoJsonFormat::geojson_track_disp(const Waypoint* trackpoint) const
 {
-
-  QJsonArray coords;
-  coords.append(trackpoint->longitude);
-  coords.append(trackpoint->latitude);
-  if (trackpoint->altitude != unknown_alt && trackpoint->altitude != 0) {
-    coords.append(trackpoint->altitude);
-  }
-  track_coords->append(coords);
+  geojson_coordinates(trackpoint);
 }
 
-void GeoJsonFormat::geojson_track_tlr(const route_head* /*unused*/)
+void GeoJsonFormat::geojson_track_tlr(const route_head* track)
 {
-  QJsonObject geometry;
-  geometry[TYPE] = LINESTRING;
-  geometry[COORDINATES] = *track_coords;
-  (*track_object)[GEOMETRY] = geometry;
-  feature_collection->append(*track_object);
-  delete track_object;
-  track_object = nullptr;
-  delete track_coords;
-  track_coords = nullptr;
+  writer->writeEndArray();
+  writer->writeName(TYPE);
+  writer->writeString(LINESTRING);
+  writer->writeEndObject();
+
+  QMap<QString, QString> properties;
+  if (!track->rte_name.isEmpty()) {
+    properties[name_opt] = track->rte_name;
+  }
+  geojson_properties(properties);
+
+  writer->writeName(TYPE);
+  writer->writeString(FEATURE);
+  writer->writeEndObject();
 }
 
 void
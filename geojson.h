@@ -22,6 +22,7 @@
 #include <QList>            // for QList
 #include <QJsonArray>       // for QJsonArray
 #include <QJsonObject>      // for QJsonObject
+#include <QMap>             // for QMap
 #include <QString>          // for QString, QStringLiteral
 #include <QVector>          // for QVector
 
@@ -29,6 +30,7 @@
 #include "format.h"         // for Format
 #include "option.h"         // for OptionBool
 #include "src/core/file.h"  // for File
+#include "src/core/jsonstreamwriter.h"  // for JsonStreamWriter
 
 class GeoJsonFormat : public Format
 {
@@ -60,22 +62,25 @@ public:
 private:
   /* Member Functions */
 
+  void geojson_coordinates(const Waypoint* waypoint) const;
+  void geojson_properties(const QMap<QString, QString>& properties) const;
   void geojson_waypt_pr(const Waypoint* waypoint) const;
+  void read_feature(const QJsonObject& feature);
   static Waypoint* waypoint_from_coordinates(const QJsonArray& coordinates);
   static void routes_from_polygon_coordinates(const QJsonArray& polygon);
   void geojson_track_hdr(const route_head* track);
   void geojson_track_disp(const Waypoint* trackpoint) const;
-  void geojson_track_tlr(const route_head* unused);
+  void geojson_track_tlr(const route_head* track);
 
   /* Data Members */
 
   gpsbabel::File* ifd{nullptr};
   gpsbabel::File* ofd{nullptr};
+  gpsbabel::JsonStreamWriter* writer{nullptr};
   OptionBool compact_opt;
   OptionString name_opt;
   OptionString desc_opt;
-  QJsonObject* track_object = nullptr;
-  QJsonArray* track_coords = nullptr;
+  OptionBool seq_opt;
 
   const QString FEATURE_COLLECTION = QStringLiteral("FeatureCollection");
   const QString FEATURE = QStringLiteral("Feature");
@@ -106,9 +111,10 @@ private:
       "desc", &desc_opt, "Property key to use for description",
       "description", ARGTYPE_STRING, ARG_NOMINMAX, nullptr
     },
+    {
+      "seq", &seq_opt, "Write one feature per line (GeoJSONSeq)",
+      nullptr, ARGTYPE_BOOL, ARG_NOMINMAX, nullptr
+    },
   };
-
-  QJsonArray* feature_collection = nullptr;
-
 };
 #endif // GEOJSON_H_INCLUDED_
@@ -22,20 +22,23 @@
 
 #include "googletakeout.h"
 
+#include <algorithm>            // for max
+#include <memory>               // for make_unique, unique_ptr
+
 #include <QChar>                // for operator==, QChar
 #include <QDateTime>            // for QDateTime
 #include <QDebug>               // for QDebug
 #include <QDir>                 // for QDir
 #include <QFileInfo>            // for QFileInfo
-#include <QIODevice>            // for operator|, QIODevice
+#include <QIODevice>            // for QIODevice
 #include <QJsonArray>           // for QJsonArray, QJsonArray::const_iterator
-#include <QJsonDocument>        // for QJsonDocument
 #include <QJsonObject>          // for QJsonObject, QJsonObject::const_iterator
-#include <QJsonParseError>      // for QJsonParseError, QJsonParseError::NoError
+#include <QThread>              // for QThread
 #include <Qt>
 
 #include "src/core/datetime.h"  // for DateTime
 #include "src/core/file.h"      // for File
+#include "src/core/jsonstreamreader.h"  // for JsonStreamReader
 #include "src/core/logging.h"   // for Debug, FatalMsg, Warning
 
 
@@ -86,51 +89,215 @@ bool GoogleTakeoutFormat::track_maybe_add_wpt(route_head* route, Waypoint* waypo
   return true;
 }
 
-QList<QJsonObject> GoogleTakeoutFormat::GoogleTakeoutInputStream::readJson(
+/*
+ * Location History files can be several GB, so a file named on its own
+ * is read with a pull parser and handed out one timelineObject at a
+ * time.  openJson() leaves the reader inside the timelineObjects array.
+ */
+void GoogleTakeoutFormat::GoogleTakeoutInputStream::openJson(
     const QString& source)
 {
   if (global_opts.debug_level >= 2) {
     Debug(2) << "Reading from JSON " << source;
   }
-  auto* ifd = new gpsbabel::File(source);
-  ifd->open(QIODevice::ReadOnly | QIODevice::Text);
-  const QString content = ifd->readAll();
-  QJsonParseError error{};
-  const QJsonDocument doc = QJsonDocument::fromJson(content.toUtf8(), &error);
-  if (error.error != QJsonParseError::NoError) {
-    takeout_fatal(
-      QString("JSON parse error in ") + ifd->fileName() + ": " +
-      error.errorString()
-    );
+  jsonSource = source;
+  timelineCount = 0;
+  ifd = std::make_unique<gpsbabel::File>(source);
+  ifd->open(QIODevice::ReadOnly);
+  reader = std::make_unique<gpsbabel::JsonStreamReader>(ifd->device());
+  QString error;
+  inTimeline = findTimeline(*reader, ifd->fileName(), error);
+  if (!error.isEmpty()) {
+    takeout_fatal(error);
   }
+}
 
-  const QJsonObject root = doc.object();
-  const QJsonValue timelineObjectsIn = root.value(TIMELINE_OBJECTS);
-  if (timelineObjectsIn.isNull()) {
-    takeout_fatal(
-      ifd->fileName() + " is missing required \"" +
-      TIMELINE_OBJECTS + "\" section"
-    );
+/* Returns the next timelineObject of the open file, or a null QJsonValue after the last one */
+QJsonValue GoogleTakeoutFormat::GoogleTakeoutInputStream::readJson()
+{
+  if (!inTimeline) {
+    return QJsonValue();
+  }
+  QString error;
+  QJsonValue timelineObject = nextTimelineObject(*reader, ifd->fileName(), error);
+  if (!error.isEmpty()) {
+    takeout_fatal(error);
+  }
+  if (timelineObject.isNull()) {
+    inTimeline = false;
+  } else {
+    ++timelineCount;
   }
+  return timelineObject;
+}
 
-  const QJsonArray timelineJson = timelineObjectsIn.toArray();
-  QList<QJsonObject> timeline;
-  for (QJsonValue&& val : timelineJson) {
-    if (val.isObject()) {
-      timeline.append(val.toObject());
-    } else {
-      takeout_fatal(ifd->fileName() + " has non-object in timelineObjects");
-    }
+void GoogleTakeoutFormat::GoogleTakeoutInputStream::closeJson()
+{
+  QString error;
+  finishJson(*reader, ifd->fileName(), error);
+  if (!error.isEmpty()) {
+    takeout_fatal(error);
   }
+  reader.reset();
   ifd->close();
-  delete ifd;
-  if (timeline.isEmpty()) {
-    takeout_warning(QString(source) + " does not contain any timelineObjects");
+  ifd.reset();
+  reportTimeline(jsonSource, timelineCount);
+}
+
+/*
+ * The helpers below are shared with the thread pool, so they report
+ * problems in error rather than through takeout_fatal().
+ */
+
+/* Move to the start of the timelineObjects array, returns false if there is none */
+bool GoogleTakeoutFormat::GoogleTakeoutInputStream::findTimeline(
+    gpsbabel::JsonStreamReader& reader, const QString& name, QString& error)
+{
+  if (reader.readNext() == gpsbabel::JsonStreamReader::StartObject) {
+    while (reader.readNext() == gpsbabel::JsonStreamReader::Name) {
+      const bool timeline = reader.name() == TIMELINE_OBJECTS;
+      reader.readNext();
+      if (timeline) {
+        if (reader.tokenType() == gpsbabel::JsonStreamReader::StartArray) {
+          return true;
+        }
+        if ((reader.tokenType() == gpsbabel::JsonStreamReader::Value) &&
+            reader.value().isNull()) {
+          error = name + " is missing required \"" + TIMELINE_OBJECTS + "\" section";
+          return false;
+        }
+      }
+      reader.skipValue();
+    }
+  } else {
+    reader.skipValue();
+  }
+  if (reader.hasError()) {
+    error = QString("JSON parse error in ") + name + ": " + reader.errorString();
+  }
+  return false;
+}
+
+/* Returns the next timelineObject, or a null QJsonValue after the last one */
+QJsonValue GoogleTakeoutFormat::GoogleTakeoutInputStream::nextTimelineObject(
+    gpsbabel::JsonStreamReader& reader, const QString& name, QString& error)
+{
+  switch (reader.readNext()) {
+  case gpsbabel::JsonStreamReader::StartObject: {
+    QJsonValue timelineObject = reader.readValue();
+    if (!reader.hasError()) {
+      return timelineObject;
+    }
+    break;
+  }
+  case gpsbabel::JsonStreamReader::EndArray:
+    return QJsonValue();
+  case gpsbabel::JsonStreamReader::Invalid:
+    break;
+  default:
+    error = name + " has non-object in timelineObjects";
+    return QJsonValue();
+  }
+  error = QString("JSON parse error in ") + name + ": " + reader.errorString();
+  return QJsonValue();
+}
+
+/* Walk the rest of the file, so errors after the timeline are still caught */
+void GoogleTakeoutFormat::GoogleTakeoutInputStream::finishJson(
+    gpsbabel::JsonStreamReader& reader, const QString& name, QString& error)
+{
+  while (reader.readNext() != gpsbabel::JsonStreamReader::EndDocument) {
+    if (reader.hasError()) {
+      error = QString("JSON parse error in ") + name + ": " + reader.errorString();
+      return;
+    }
+    reader.skipValue();
+  }
+}
+
+void GoogleTakeoutFormat::GoogleTakeoutInputStream::reportTimeline(
+    const QString& source, int count)
+{
+  if (count == 0) {
+    takeout_warning(source + " does not contain any timelineObjects");
   }
   if (global_opts.debug_level >= 2) {
-    Debug(2) << "Saw " << timeline.size() << " timelineObjects in " << source;
+    Debug(2) << "Saw " << count << " timelineObjects in " << source;
+  }
+}
+
+/* Runs on the thread pool, must not touch any globals. */
+void GoogleTakeoutFormat::GoogleTakeoutInputStream::readBatch(TimelineBatch& batch)
+{
+  const QString name = batch.file->fileName();
+  gpsbabel::JsonStreamReader reader(batch.file->device());
+  if (findTimeline(reader, name, batch.error)) {
+    for (;;) {
+      QJsonValue timelineObject = nextTimelineObject(reader, name, batch.error);
+      if (timelineObject.isNull()) {
+        break;
+      }
+      batch.timeline.append(timelineObject.toObject());
+    }
+  }
+  if (batch.error.isEmpty()) {
+    finishJson(reader, name, batch.error);
+  }
+  batch.file->close();
+}
+
+/*
+ * A folder holds a file per month, often hundreds of them.  Read the
+ * next few on the thread pool at once, each into a batch of its own.
+ * The files are opened here, as failing to open one is fatal.
+ */
+void GoogleTakeoutFormat::GoogleTakeoutInputStream::loadBatches()
+{
+  const auto batch_size = static_cast<std::size_t>(2 * std::max(1, QThread::idealThreadCount()));
+  batches.clear();
+  while (!files.isEmpty() && (batches.size() < batch_size)) {
+    TimelineBatch& batch = batches.emplace_back();
+    batch.file = std::make_unique<gpsbabel::File>(files.takeFirst());
+    batch.file->open(QIODevice::ReadOnly);
   }
-  return timeline;
+  for (auto& batch : batches) {
+    TimelineBatch* b = &batch;
+    pool.start([b]() {
+      readBatch(*b);
+    });
+  }
+  pool.waitForDone();
+  batchIndex = 0;
+  timelineIndex = 0;
+}
+
+/*
+ * Hand out the timelineObjects of the batches in file order, which for
+ * a folder is chronological, so the result is that of reading the files
+ * one after the other.
+ */
+QJsonValue GoogleTakeoutFormat::GoogleTakeoutInputStream::readBatches()
+{
+  while (batchIndex < batches.size()) {
+    TimelineBatch& batch = batches[batchIndex];
+    const QString source = batch.file->fileName();
+    if (timelineIndex == 0) {
+      if (global_opts.debug_level >= 2) {
+        Debug(2) << "Reading from JSON " << source;
+      }
+      if (!batch.error.isEmpty()) {
+        takeout_fatal(batch.error);
+      }
+    }
+    if (timelineIndex < batch.timeline.size()) {
+      return batch.timeline.at(timelineIndex++);
+    }
+    reportTimeline(source, batch.timeline.size());
+    batch.timeline.clear();
+    ++batchIndex;
+    timelineIndex = 0;
+  }
+  return QJsonValue();
 }
 
 QList<QString> GoogleTakeoutFormat::GoogleTakeoutInputStream::readDir(
@@ -401,27 +568,42 @@ GoogleTakeoutFormat::add_activity_segment(const QJsonObject& activitySegment)
 void GoogleTakeoutFormat::GoogleTakeoutInputStream::loadSource(const QString& source) {
   const QFileInfo info{source};
   if (info.isDir()) {
-    sources += readDir(source);
+    /* Find all the files of the folder up front, so they can be read in parallel */
+    for (auto&& path : readDir(source)) {
+      if (QFileInfo(path).isDir()) {
+        loadSource(path);
+      } else {
+        files.append(path);
+      }
+    }
   } else if (info.exists()) {
-    timelineObjects.append(readJson(source));
+    openJson(source);
   } else {
     takeout_fatal(source + ": No such file or directory");
   }
 }
 
 QJsonValue GoogleTakeoutFormat::GoogleTakeoutInputStream::next() {
-  if (!timelineObjects.isEmpty()) {
-    QJsonValue nextObject = timelineObjects.first();
-    timelineObjects.removeFirst();
-    return nextObject;
-  }
+  for (;;) {
+    if (reader) {
+      QJsonValue nextObject = readJson();
+      if (!nextObject.isNull()) {
+        return nextObject;
+      }
+      closeJson();
+    }
 
-  if (!sources.isEmpty()) {
-    const QString filename = sources.first();
-    sources.removeFirst();
-    loadSource(filename);
-    return next();
-  }
+    QJsonValue nextObject = readBatches();
+    if (!nextObject.isNull()) {
+      return nextObject;
+    }
 
-  return QJsonValue();
+    if (!files.isEmpty()) {
+      loadBatches();
+    } else if (!sources.isEmpty()) {
+      loadSource(sources.takeFirst());
+    } else {
+      return QJsonValue();
+    }
+  }
 }
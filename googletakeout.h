@@ -22,14 +22,22 @@
 #ifndef GOOGLETAKEOUT_H_INCLUDED_
 #define GOOGLETAKEOUT_H_INCLUDED_
 
+#include <cstddef>         // for size_t
+#include <memory>          // for unique_ptr
+#include <vector>          // for vector
+
 #include <QJsonObject>     // for QJsonObject
 #include <QJsonValue>      // for QJsonValue
 #include <QList>           // for QList
 #include <QString>         // for QString
+#include <QThreadPool>     // for QThreadPool
 #include <QVector>         // for QVector
+#include <QtGlobal>        // for qsizetype
 
 #include "defs.h"
 #include "format.h"        // for Format
+#include "src/core/file.h" // for File
+#include "src/core/jsonstreamreader.h"  // for JsonStreamReader
 
 /*
  * Reads Location History JSON files and return each timelineObject
@@ -106,16 +114,45 @@ private:
     QJsonValue next();
 
   private:
+    /* Types */
+
+    // The timelineObjects of one file of a folder, read on the thread pool
+    struct TimelineBatch {
+      std::unique_ptr<gpsbabel::File> file;
+      QList<QJsonObject> timeline;
+      QString error;
+    };
+
     /* Member Functions */
 
-    static QList<QJsonObject> readJson(const QString& source);
+    void openJson(const QString& source);
+    QJsonValue readJson();
+    void closeJson();
+    static bool findTimeline(gpsbabel::JsonStreamReader& reader, const QString& name, QString& error);
+    static QJsonValue nextTimelineObject(gpsbabel::JsonStreamReader& reader, const QString& name, QString& error);
+    static void finishJson(gpsbabel::JsonStreamReader& reader, const QString& name, QString& error);
+    static void reportTimeline(const QString& source, int count);
+    static void readBatch(TimelineBatch& batch);
+    void loadBatches();
+    QJsonValue readBatches();
     static QList<QString> readDir(const QString& source);
     void loadSource(const QString& source);
 
     /* Data Members */
 
     QList<QString> sources;
-    QList<QJsonObject> timelineObjects;
+    /* The file being read, positioned inside its timelineObjects array */
+    QString jsonSource;
+    std::unique_ptr<gpsbabel::File> ifd;
+    std::unique_ptr<gpsbabel::JsonStreamReader> reader;
+    bool inTimeline{false};
+    int timelineCount{0};
+    /* Files found in folders, and those of them that have been read */
+    QList<QString> files;
+    std::vector<TimelineBatch> batches;
+    std::size_t batchIndex{0};
+    qsizetype timelineIndex{0};
+    QThreadPool pool;
   };
 
   /* Member Functions */
@@ -944,7 +944,7 @@ GpxFormat::rd_init(const QString& fname)
 {
   iqfile = new gpsbabel::File(fname);
   iqfile->open(QIODevice::ReadOnly);
-  reader = new QXmlStreamReader(iqfile);
+  reader = new QXmlStreamReader(iqfile->device());
 
   current_tag.clear();
 
@@ -976,7 +976,7 @@ GpxFormat::wr_init(const QString& fname)
   oqfile = new gpsbabel::File(fname);
   oqfile->open(QIODevice::WriteOnly | QIODevice::Text);
 
-  writer = new gpsbabel::XmlStreamWriter(oqfile);
+  writer = new gpsbabel::XmlStreamWriter(oqfile->device());
   writer->setAutoFormattingIndent(2);
   writer->writeStartDocument();
 
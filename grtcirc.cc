@@ -118,25 +118,27 @@ double heading_true_degrees(PositionRad pos1, PositionRad pos2)
 // Note: This is probably not going to vectorize as it uses statics internally,
 // so it's hard for the optimizer to prove it's a pure function with no side
 // effects, right?
+// The statics cache the last line and are per thread, so this may be used
+// from several threads at once.
 std::tuple<double, PositionDeg, double> linedistprj(PositionRad pos1,
                                                     PositionRad pos2,
                                                     PositionRad pos3)
 {
-  static double _lat1 = -9999;
-  static double _lat2 = -9999;
-  static double _lon1 = -9999;
-  static double _lon2 = -9999;
-
-  static double x1;
-  static double y1;
-  static double z1;
-  static double x2;
-  static double y2;
-  static double z2;
-  static double xa;
-  static double ya;
-  static double za;
-  static double la;
+  thread_local double _lat1 = -9999;
+  thread_local double _lat2 = -9999;
+  thread_local double _lon1 = -9999;
+  thread_local double _lon2 = -9999;
+
+  thread_local double x1;
+  thread_local double y1;
+  thread_local double z1;
+  thread_local double x2;
+  thread_local double y2;
+  thread_local double z2;
+  thread_local double xa;
+  thread_local double ya;
+  thread_local double za;
+  thread_local double la;
 
   double dot;
 
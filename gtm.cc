@@ -26,6 +26,7 @@
 
 #include "gtm.h"
 
+#include <algorithm>            // for min
 #include <cstdio>               // for SEEK_CUR
 #include <cstring>              // for strlen, memset
 
@@ -318,6 +319,7 @@ GtmFormat::read()
   }
 
   /* Waypoints */
+  waypt_reserve(waypt_count() + std::min(wp_count, kMaxReserve));
   for (i = 0; i != wp_count; i++) {
     wpt = new Waypoint;
     wpt->latitude = fread_double(file_in);
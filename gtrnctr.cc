@@ -87,7 +87,7 @@ GtrnctrFormat::wr_init(const QString& fname)
   ofile = new gpsbabel::File(fname);
   ofile->open(QIODevice::WriteOnly | QIODevice::Text);
 
-  fout = new gpsbabel::XmlStreamWriter(ofile);
+  fout = new gpsbabel::XmlStreamWriter(ofile->device());
   fout->setAutoFormatting(true);
   fout->setAutoFormattingIndent(2);
 
@@ -27,19 +27,20 @@
 
 #include <cassert>              // for assert
 #include <cmath>                // for fabs, lround
+#include <cstddef>              // for size_t
 #include <cstdio>               // for sscanf, printf, snprintf, size_t
 #include <cstdlib>              // for labs, ldiv, ldiv_t, abs
 #include <cstring>              // for strcmp, strlen, strtok, strcat, strchr, strcpy, strncat
-#include <iterator>             // for reverse_iterator, operator==, prev, next
 #include <optional>             // for optional
 #include <tuple>                // for std::make_tuple
+#include <vector>               // for vector
 
 #include <QByteArray>           // for QByteArray
 #include <QChar>                // for QChar
 #include <QLatin1Char>          // for QLatin1Char
 #include <QDate>                // for QDate
 #include <QDateTime>            // for QDateTime
-#include <QList>                // for QList<>::const_iterator
+#include <QList>                // for QList
 #include <QString>              // for QString, operator+, QStringLiteral
 #include <QStringList>          // for QStringList
 #include <QTime>                // for operator<, operator==, QTime
@@ -821,6 +822,21 @@ void IgcFormat::wr_fix_record(const Waypoint* wpt, int pres_alt, int gnss_alt)
             latlon2str(wpt).constData(), pres_alt, gnss_alt);
 }
 
+/**
+ * Extract the time, altitude and position of each point of a track
+ * so that the track merge doesn't have to repeatedly walk the
+ * waypoint list and do QDateTime arithmetic.
+ */
+std::vector<IgcFormat::TrackSample> IgcFormat::extract_samples(const route_head* track)
+{
+  std::vector<TrackSample> samples;
+  samples.reserve(track->rte_waypt_ct());
+  for (const Waypoint* wpt : track->waypoint_list) {
+    samples.push_back({wpt->GetCreationTime().toMSecsSinceEpoch(), wpt->altitude, wpt->position()});
+  }
+  return samples;
+}
+
 /**
  * Attempt to align the pressure and GNSS tracks in time.
  * This is useful when trying to merge a track (lat/lon/time) recorded by a
@@ -829,57 +845,63 @@ void IgcFormat::wr_fix_record(const Waypoint* wpt, int pres_alt, int gnss_alt)
  * @return The number of seconds to add to the GNSS track in order to align
  *         it with the pressure track.
  */
-int IgcFormat::correlate_tracks(const route_head* pres_track, const route_head* gnss_track)
+int IgcFormat::correlate_tracks(const std::vector<TrackSample>& pres_samples, const std::vector<TrackSample>& gnss_samples)
 {
   double alt_diff;
   double speed;
 
+  if (pres_samples.empty() || gnss_samples.empty()) {
+    return 0;
+  }
+
   // Deduce the landing time from the pressure altitude track based on
   // when we last descended to within 10m of the final track altitude.
-  WaypointList::const_reverse_iterator wpt_rit = pres_track->waypoint_list.crbegin();
-  double last_alt = (*wpt_rit)->altitude;
+  std::size_t idx = pres_samples.size() - 1;
+  double last_alt = pres_samples[idx].alt;
   do {
-    ++wpt_rit;
-    if (pres_track->waypoint_list.crend() == wpt_rit) {
+    if (idx == 0) {
       // No track left
       return 0;
     }
-    alt_diff = last_alt - (*wpt_rit)->altitude;
+    --idx;
+    alt_diff = last_alt - pres_samples[idx].alt;
     if (alt_diff > 10.0) {
       // Last part of track was ascending
       return 0;
     }
   } while (alt_diff > -10.0);
-  gpsbabel::DateTime pres_time = (*std::prev(wpt_rit))->GetCreationTime();
+  qint64 pres_time = pres_samples[idx + 1].msecs;
   if (global_opts.debug_level >= 1) {
-    gbDebug("pressure landing time %s\n", CSTR(pres_time.toPrettyString()));
+    gpsbabel::DateTime dt = QDateTime::fromMSecsSinceEpoch(pres_time, QtUTC);
+    gbDebug("pressure landing time %s\n", CSTR(dt.toPrettyString()));
   }
 
   // Deduce the landing time from the GNSS altitude track based on
   // when the groundspeed last dropped below a certain level.
-  wpt_rit = gnss_track->waypoint_list.crbegin();
+  idx = gnss_samples.size() - 1;
   do {
-    const Waypoint* wpt = *wpt_rit;
-    ++wpt_rit;
-    if (gnss_track->waypoint_list.crend() == wpt_rit) {
+    const TrackSample& sample = gnss_samples[idx];
+    if (idx == 0) {
       // No track left
       return 0;
     }
+    --idx;
     // Get a crude indication of groundspeed from the change in lat/lon
-    int deltat_msec = (*wpt_rit)->GetCreationTime().msecsTo(wpt->GetCreationTime());
+    qint64 deltat_msec = sample.msecs - gnss_samples[idx].msecs;
     speed = (deltat_msec == 0) ? 0:
-            radtometers(gcdist(wpt->position(), (*wpt_rit)->position())) /
+            radtometers(gcdist(sample.pos, gnss_samples[idx].pos)) /
             (0.001 * deltat_msec);
     if (global_opts.debug_level >= 2) {
       gbDebug("speed=%.2fm/s\n", speed);
     }
   } while (speed < 2.5);
-  gpsbabel::DateTime gnss_time = (*std::prev(wpt_rit))->GetCreationTime();
+  qint64 gnss_time = gnss_samples[idx + 1].msecs;
   if (global_opts.debug_level >= 1) {
-    gbDebug("gnss landing time %s\n", CSTR(gnss_time.toPrettyString()));
+    gpsbabel::DateTime dt = QDateTime::fromMSecsSinceEpoch(gnss_time, QtUTC);
+    gbDebug("gnss landing time %s\n", CSTR(dt.toPrettyString()));
   }
   // Time adjustment is difference between the two estimated landing times
-  int time_diff = gnss_time.secsTo(pres_time);
+  int time_diff = (pres_time - gnss_time) / 1000;
   if (15 * 60 < abs(time_diff)) {
     gbWarning("excessive time adjustment %ds\n", time_diff);
   }
@@ -888,46 +910,41 @@ int IgcFormat::correlate_tracks(const route_head* pres_track, const route_head*
 
 /**
  * Interpolate altitude from a track at a given time.
- * @param  track  The track containing altitude data.
- * @param  time   The time that we are interested in.
+ * Successive calls must be made with non-decreasing times, which lets
+ * the whole merge be a single pass over both tracks.
+ * @param  msecs  The time that we are interested in, in milliseconds since epoch.
  * @return  The altitude interpolated from the track.
  */
-double IgcFormat::Interpolater::interpolate_alt(const route_head* track, const gpsbabel::DateTime& time)
+double IgcFormat::Interpolater::interpolate_alt(qint64 msecs)
 {
-  int time_diff;
-
-  // Start search at the beginning of the track
-  if (!prev_wpt.has_value()) {
-    prev_wpt = track->waypoint_list.cbegin();
-    curr_wpt = track->waypoint_list.cbegin();
-  }
   // Find the track points either side of the requested time
-  while ((track->waypoint_list.cend() != *curr_wpt) &&
-         ((**curr_wpt)->GetCreationTime() < time)) {
-    prev_wpt = *curr_wpt;
-    curr_wpt = std::next(*prev_wpt);
+  while ((curr_ < samples_.size()) && (samples_[curr_].msecs < msecs)) {
+    ++curr_;
   }
-  if (track->waypoint_list.cend() == *curr_wpt) {
+  if (curr_ >= samples_.size()) {
     // Requested time later than all track points, we can't interpolate
     return unknown_alt;
   }
 
-  if (track->waypoint_list.cbegin() == *curr_wpt) {
-    if ((**curr_wpt)->GetCreationTime() == time) {
+  const TrackSample& curr = samples_[curr_];
+  if (curr_ == 0) {
+    if (curr.msecs == msecs) {
       // First point's creation time is an exact match so use it's altitude
-      return (**curr_wpt)->altitude;
+      return curr.alt;
     } else {
       // Requested time is prior to any track points, we can't interpolate
       return unknown_alt;
     }
   }
   // Interpolate
-  if (0 == (time_diff = (**prev_wpt)->GetCreationTime().secsTo((**curr_wpt)->GetCreationTime()))) {
+  const TrackSample& prev = samples_[curr_ - 1];
+  if (curr.msecs == prev.msecs) {
     // Avoid divide by zero
-    return (**curr_wpt)->altitude;
+    return curr.alt;
   }
-  double alt_diff = (**curr_wpt)->altitude - (**prev_wpt)->altitude;
-  return (**prev_wpt)->altitude + (alt_diff / time_diff) * ((**prev_wpt)->GetCreationTime().secsTo(time));
+  double time_diff = (curr.msecs - prev.msecs) / 1000.0;
+  double alt_diff = curr.alt - prev.alt;
+  return prev.alt + (alt_diff / time_diff) * ((msecs - prev.msecs) / 1000.0);
 }
 
 /*
@@ -945,9 +962,11 @@ void IgcFormat::wr_track()
 
   // If both found, attempt to merge them
   if (pres_track && gnss_track) {
+    const std::vector<TrackSample> pres_samples = extract_samples(pres_track);
+    const std::vector<TrackSample> gnss_samples = extract_samples(gnss_track);
     if (timeadj) {
       if (timeadj.get() == "auto") {
-        time_adj = correlate_tracks(pres_track, gnss_track);
+        time_adj = correlate_tracks(pres_samples, gnss_samples);
       } else {
         time_adj = timeadj.toInt();
       }
@@ -958,9 +977,11 @@ void IgcFormat::wr_track()
       gbDebug("adjusting time by %ds\n", time_adj);
     }
     // Iterate through waypoints in both tracks simultaneously
-    Interpolater interpolater;
-    foreach (const Waypoint* wpt, gnss_track->waypoint_list) {
-      double pres_alt = interpolater.interpolate_alt(pres_track, wpt->GetCreationTime().addSecs(time_adj));
+    Interpolater interpolater(pres_samples);
+    const qint64 adj_msecs = time_adj * 1000LL;
+    std::size_t idx = 0;
+    for (const Waypoint* wpt : gnss_track->waypoint_list) {
+      double pres_alt = interpolater.interpolate_alt(gnss_samples[idx++].msecs + adj_msecs);
       wr_fix_record(wpt, pres_alt, wpt->altitude);
     }
   } else {
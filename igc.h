@@ -28,7 +28,9 @@
 #ifndef IGC_H_INCLUDED_
 #define IGC_H_INCLUDED_
 
+#include <cstddef>              // for size_t
 #include <optional>             // for optional
+#include <vector>               // for vector
 
 #include <QByteArray>           // for QByteArray
 #include <QDateTime>            // for QDateTime
@@ -250,14 +252,22 @@ private:
     state_t state{state_t::id};
   };
 
+  /* Time and position of a track point, extracted once for the track merge. */
+  struct TrackSample {
+    qint64 msecs;	/* milliseconds since epoch */
+    double alt;
+    PositionDeg pos;
+  };
+
   class Interpolater
   {
   public:
-    double interpolate_alt(const route_head* track, const gpsbabel::DateTime& time);
+    explicit Interpolater(const std::vector<TrackSample>& samples) : samples_(samples) {}
+    double interpolate_alt(qint64 msecs);
 
   private:
-    std::optional<WaypointList::const_iterator> prev_wpt;
-    std::optional<WaypointList::const_iterator> curr_wpt;
+    const std::vector<TrackSample>& samples_;
+    std::size_t curr_{0};
   };
 
   /* Constants */
@@ -285,7 +295,8 @@ private:
   void wr_task_tlr(const route_head* rte);
   void wr_tasks();
   void wr_fix_record(const Waypoint* wpt, int pres_alt, int gnss_alt);
-  static int correlate_tracks(const route_head* pres_track, const route_head* gnss_track);
+  static std::vector<TrackSample> extract_samples(const route_head* track);
+  static int correlate_tracks(const std::vector<TrackSample>& pres_samples, const std::vector<TrackSample>& gnss_samples);
   void wr_track();
 
   /* Data Members */
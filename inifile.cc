@@ -188,7 +188,7 @@ inifile_init(const QString& filename)
 
   gpsbabel::File file(name);
   file.open(QFile::ReadOnly);
-  QTextStream stream(&file);
+  QTextStream stream(file.device());
   // default for QTextStream::setEncoding in Qt6 is QStringConverter::Utf8
   stream.setAutoDetectUnicode(true);
 
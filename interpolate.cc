@@ -25,8 +25,10 @@
 #include <cmath>                // for ceil, isfinite
 #include <cstdlib>              // for abs
 #include <optional>             // for optional
+#include <vector>               // for vector
 
 #include <QString>              // for QString
+#include <QStringLiteral>       // for QStringLiteral
 #include <QtGlobal>             // for qint64, qRound64
 
 #include "defs.h"
@@ -43,32 +45,43 @@ void InterpolateFilter::process()
     gbFatal(FatalMsg() << "Found no routes or tracks to operate on.");
   }
 
-  auto process_rte_lambda = [this](const route_head* rte)->void {
-    process_rte(const_cast<route_head*>(rte));
-  };
-  if (opt_route) {
-    route_disp_all(process_rte_lambda, nullptr, nullptr);
-  } else {
-    track_disp_all(process_rte_lambda, nullptr, nullptr);
+  const RouteList& routes = opt_route ? *global_route_list : *global_track_list;
+  std::vector<RouteResult> results = parallel_map_routes(routes, [this](const route_head* rte, RouteResult& result)->void {
+    interpolate_rte(rte, result);
+  });
+
+  // Replace the wpts with the interpolated ones, in route order.
+  auto result = results.begin();
+  for (route_head* rte : routes) {
+    if (!result->error.isEmpty()) {
+      gbFatal(FatalMsg().noquote() << result->error);
+    }
+    WaypointList wptlist;
+    if (opt_route) {
+      route_swap_wpts(rte, wptlist);
+      route_add_wpts(rte, result->wpts);
+    } else {
+      track_swap_wpts(rte, wptlist);
+      track_add_wpts(rte, result->wpts);
+    }
+    ++result;
   }
 }
 
-void InterpolateFilter::process_rte(route_head* rte)
+/*
+ * Build the new wpt list for rte, the original wpts with interpolated
+ * points interspersed.  This runs on a worker thread, see
+ * Filter::parallel_map_routes.
+ */
+void InterpolateFilter::interpolate_rte(const route_head* rte, RouteResult& result) const
 {
-  // Steal all the wpts
-  WaypointList wptlist;
-  if (opt_route) {
-    route_swap_wpts(rte, wptlist);
-  } else {
-    track_swap_wpts(rte, wptlist);
-  }
+  result.wpts.reserve(rte->rte_waypt_ct());
 
-  // And add them back, with interpolated points interspersed.
   PositionDeg pos1;
   double altitude1 = unknown_alt;
   gpsbabel::DateTime time1;
   bool first = true;
-  foreach (Waypoint* wpt, wptlist) {
+  for (Waypoint* wpt : rte->waypoint_list) {
     if (first) {
       first = false;
     } else {
@@ -85,7 +98,8 @@ void InterpolateFilter::process_rte(route_head* rte)
       double npts = 0;
       if (opt_time) {
         if (!timespan.has_value()) {
-          gbFatal(FatalMsg() << "points must have valid times to interpolate by time!");
+          result.error = QStringLiteral("points must have valid times to interpolate by time!");
+          return;
         }
         // interpolate even if time is running backwards.
         npts = std::abs(*timespan) / max_time_step;
@@ -94,7 +108,8 @@ void InterpolateFilter::process_rte(route_head* rte)
         npts = distspan / max_dist_step;
       }
       if (!std::isfinite(npts) || (npts >= INT_MAX)) {
-        gbFatal(FatalMsg() << "interpolation interval too small!");
+        result.error = QStringLiteral("interpolation interval too small!");
+        return;
       }
 
       // Insert the required points
@@ -120,18 +135,10 @@ void InterpolateFilter::process_rte(route_head* rte)
         } else {
           wpt_new->altitude = unknown_alt;
         }
-        if (opt_route) {
-          route_add_wpt(rte, wpt_new);
-        } else {
-          track_add_wpt(rte, wpt_new);
-        }
+        result.wpts.append(wpt_new);
       }
     }
-    if (opt_route) {
-      route_add_wpt(rte, wpt);
-    } else {
-      track_add_wpt(rte, wpt);
-    }
+    result.wpts.append(wpt);
 
     pos1 = wpt->position();
     altitude1 = wpt->altitude;
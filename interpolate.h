@@ -45,7 +45,7 @@ public:
 private:
   /* Member Functions */
 
-  void process_rte(route_head* rte);
+  void interpolate_rte(const route_head* rte, RouteResult& result) const;
 
   /* Data Members */
 
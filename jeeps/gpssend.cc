@@ -26,6 +26,7 @@
 #include <cctype>
 #include <cerrno>
 #include <cstdio>
+#include <cstring>
 
 #include "jeeps/gps.h"
 #include "jeeps/gpsserial.h"
@@ -118,10 +119,12 @@ DiagS(void* buf, size_t sz)
 
 int32_t GPS_Serial_Write_Packet(gpsdevh* fd, const GPS_Packet& packet)
 {
-	int32_t ret;
+  int32_t ret;
   const char* m1, *m2;
   GPS_Serial_Packet ser_pkt;
   UC ser_pkt_data[MAX_GPS_PACKET_SIZE * sizeof(UC)];
+  /* Stuffing can at most double the payload, plus header and trailer. */
+  UC frame[2 * MAX_GPS_PACKET_SIZE + 8];
   US bytes;
 
   if (packet.type >= 0xff || packet.n >= 0xff) {
@@ -132,44 +135,36 @@ int32_t GPS_Serial_Write_Packet(gpsdevh* fd, const GPS_Packet& packet)
   ser_pkt.data = ser_pkt_data;
   bytes = Build_Serial_Packet(packet, &ser_pkt);
 
-  GPS_Diag("Tx Data:");
-  Diag(&ser_pkt.dle, 3);
-  if ((ret=GPS_Serial_Write(fd,(const void*) &ser_pkt.dle,(size_t)3)) == -1) {
-    perror("write");
-    GPS_Error("SEND: Write to GPS failed");
-    return 0;
-  }
-  if (ret!=3) {
-    GPS_Error("SEND: Incomplete write to GPS");
-    return 0;
-  }
-
-  Diag(ser_pkt.data, bytes);
-  if ((ret=GPS_Serial_Write(fd,(const void*)ser_pkt.data,(size_t)bytes)) == -1) {
-    perror("write");
-    GPS_Error("SEND: Write to GPS failed");
-    return 0;
-  }
-  if (ret!=bytes) {
-    GPS_Error("SEND: Incomplete write to GPS");
-    return 0;
-  }
-
-
-  Diag(&ser_pkt.chk, 3);
+  /*
+   * Send the whole frame with a single write.  USB serial adapters
+   * turn every write into a transfer of its own, so writing header,
+   * payload and trailer separately tripled the cost of each ack.
+   */
+  UC* q = frame;
+  *q++ = ser_pkt.dle;
+  *q++ = ser_pkt.type;
+  *q++ = ser_pkt.n;
+  memcpy(q, ser_pkt.data, bytes);
+  q += bytes;
+  *q++ = ser_pkt.chk;
+  *q++ = ser_pkt.edle;
+  *q++ = ser_pkt.etx;
+  int size = q - frame;
 
+  GPS_Diag("Tx Data:");
+  Diag(frame, size);
   GPS_Diag(": ");
   DiagS(ser_pkt.data, bytes);
   DiagS(&ser_pkt.chk, 3);
   m1 = Get_Pkt_Type(ser_pkt.type, ser_pkt.data[0], &m2);
   GPS_Diag("(%-8s%s)\n", m1, m2 ? m2 : "");
 
-  if ((ret=GPS_Serial_Write(fd,(const void*)&ser_pkt.chk,(size_t)3)) == -1) {
+  if ((ret=GPS_Serial_Write(fd,(const void*)frame,size)) == -1) {
     perror("write");
     GPS_Error("SEND: Write to GPS failed");
     return 0;
   }
-  if (ret!=3) {
+  if (ret!=size) {
     GPS_Error("SEND: Incomplete write to GPS");
     return 0;
   }
@@ -27,8 +27,10 @@
 #include "gbser.h"
 #include "jeeps/gpsserial.h"
 #include <QThread>
+#include <algorithm>
 #include <cerrno>
 #include <cstdio>
+#include <cstring>
 #include <ctime>
 #include <fcntl.h>
 #include <sys/stat.h>
@@ -320,6 +322,14 @@ int32_t GPS_Serial_Set_Baud_Rate(gpsdevh* fd, int br)
 typedef struct {
   int fd;		/* File descriptor */
   struct termios gps_ttysave;
+  /*
+   * Bytes read from the port but not yet consumed.  The packet reader
+   * works a byte at a time; refilling this in bulk saves it a select()
+   * and a read() per byte.
+   */
+  UC rbuf[1024];
+  int rhead;
+  int rtail;
 } posix_serial_data;
 
 /* @func GPS_Serial_Open ***********************************************
@@ -422,7 +432,21 @@ int32_t GPS_Serial_Read(gpsdevh* dh, void* ibuf, int size)
   return 1;
 
 #else
-  return read(psd->fd, ibuf, size);
+  if (psd->rhead == psd->rtail) {
+    if (size >= (int) sizeof(psd->rbuf)) {
+      return read(psd->fd, ibuf, size);
+    }
+    int cnt = read(psd->fd, psd->rbuf, sizeof(psd->rbuf));
+    if (cnt <= 0) {
+      return cnt;
+    }
+    psd->rhead = 0;
+    psd->rtail = cnt;
+  }
+  int cnt = std::min(size, psd->rtail - psd->rhead);
+  memcpy(ibuf, psd->rbuf + psd->rhead, cnt);
+  psd->rhead += cnt;
+  return cnt;
 #endif
 }
 
@@ -445,6 +469,7 @@ int32_t GPS_Serial_Flush(gpsdevh* fd)
 {
   auto* psd = (posix_serial_data*)fd;
 
+  psd->rhead = psd->rtail = 0;
   if (tcflush(psd->fd,TCIOFLUSH)) {
     GPS_Serial_Error("SERIAL: tcflush error");
     gps_errno = SERIAL_ERROR;
@@ -512,6 +537,10 @@ int32_t GPS_Serial_Chars_Ready(gpsdevh* dh)
   }
 #endif
 
+  if (psd->rhead != psd->rtail) {
+    return 1;
+  }
+
   FD_ZERO(&rec);
   FD_SET(fd,&rec);
 
@@ -544,6 +573,10 @@ int32_t GPS_Serial_Wait(gpsdevh* dh)
   struct timeval t;
   auto* psd = (posix_serial_data*)dh;
 
+  if (psd->rhead != psd->rtail) {
+    return 1;
+  }
+
   FD_ZERO(&rec);
   FD_SET(psd->fd,&rec);
 
@@ -648,16 +681,19 @@ int32_t GPS_Serial_Set_Baud_Rate(gpsdevh* fd, int br)
   if (!GPS_Send_Ack(fd, &tra, &rec)) {
     return gps_errno;
   }
+
+  // Wait until the ack has actually left the port instead of sleeping
+  // for a fixed time; flushing first could throw it away.
+  auto* psd = (posix_serial_data*)fd;
+  tcdrain(psd->fd);
   GPS_Device_Flush(fd);
   GPS_Device_Wait(fd);
 
-  // Sleep for a small amount of time, about 100 milliseconds,
-  // to make sure the packet was successfully transmitted to the GPS unit.
-    QThread::usleep(100000);
-
-  // Change port speed
-  auto* psd = (posix_serial_data*)fd;
-  tty = psd->gps_ttysave;
+  // Change port speed, keeping the raw mode we set up in GPS_Serial_Open.
+  if (tcgetattr(psd->fd,&tty)==-1) {
+    GPS_Serial_Error("SERIAL: tcgetattr error");
+    return 0;
+  }
 
   cfsetospeed(&tty,speed);
   cfsetispeed(&tty,speed);
@@ -23,7 +23,7 @@
 #include "kml.h"
 
 #include <cmath>                       // for fabs
-#include <cstdio>                      // for sscanf, EOF
+#include <cstdio>                      // for sscanf
 #include <optional>                    // for optional
 #include <tuple>                       // for tuple, make_tuple
 
@@ -38,6 +38,7 @@
 #include <QString>                     // for QString, QStringLiteral, operator+, operator!=
 #include <QStringList>                 // for QStringList
 #include <QStringLiteral>              // for qMakeStringPrivate, QStringLit...
+#include <QStringView>                 // for QStringView
 #include <QVector>                     // for QVector
 #include <QXmlStreamAttributes>        // for QXmlStreamAttributes
 #include <Qt>                          // for ISODate
@@ -233,6 +234,52 @@ void KmlFormat::wpt_icon(const QString& args, const QXmlStreamAttributes* /*attr
   }
 }
 
+/*
+ * Find the next whitespace delimited token in text starting at pos.
+ * The token is returned as a view into text, so no strings are allocated
+ * while walking the often very long coordinate lists.
+ */
+bool KmlFormat::next_coord_token(QStringView text, qsizetype& pos, QStringView& token)
+{
+  const qsizetype len = text.size();
+  while ((pos < len) && text[pos].isSpace()) {
+    ++pos;
+  }
+  if (pos >= len) {
+    return false;
+  }
+  const qsizetype start = pos;
+  while ((pos < len) && !text[pos].isSpace()) {
+    ++pos;
+  }
+  token = text.mid(start, pos - start);
+  return true;
+}
+
+/*
+ * Split a "lon,lat[,alt]" tuple in place.
+ * Returns the number of comma separated fields, the first three of which
+ * are converted into coords.  Unparsable fields convert to zero.
+ */
+int KmlFormat::split_coord_tuple(QStringView tuple, double (&coords)[3])
+{
+  int fields = 0;
+  qsizetype start = 0;
+  for (;;) {
+    qsizetype comma = tuple.indexOf(u',', start);
+    QStringView field = tuple.mid(start, (comma < 0) ? -1 : comma - start);
+    if (fields < 3) {
+      coords[fields] = field.toDouble();
+    }
+    ++fields;
+    if (comma < 0) {
+      break;
+    }
+    start = comma + 1;
+  }
+  return fields;
+}
+
 void KmlFormat::trk_coord(const QString& args, const QXmlStreamAttributes* /*attrs*/)
 {
   auto* trk_head = new route_head;
@@ -241,20 +288,30 @@ void KmlFormat::trk_coord(const QString& args, const QXmlStreamAttributes* /*att
   }
   track_add_head(trk_head);
 
-  const auto vecs = args.simplified().split(' ');
-  for (const auto& vec : vecs) {
-    const QStringList coords = vec.split(',');
-    auto csize = coords.size();
+  QStringView text(args);
+  qsizetype pos = 0;
+  QStringView tuple;
+  // Size the track once, counting tuples is much cheaper than parsing them.
+  qsizetype npts = 0;
+  while (next_coord_token(text, pos, tuple)) {
+    ++npts;
+  }
+  trk_head->waypoint_list.reserve(npts);
+
+  pos = 0;
+  while (next_coord_token(text, pos, tuple)) {
+    double coords[3];
+    int csize = split_coord_tuple(tuple, coords);
     auto* trkpt = new Waypoint;
 
     if (csize == 3) {
-      trkpt->altitude = coords[2].toDouble();
+      trkpt->altitude = coords[2];
     }
     if (csize == 2 || csize == 3) {
-      trkpt->latitude = coords[1].toDouble();
-      trkpt->longitude = coords[0].toDouble();
+      trkpt->latitude = coords[1];
+      trkpt->longitude = coords[0];
     } else {
-      Warning() << "malformed coordinates " << vec;
+      Warning() << "malformed coordinates " << tuple.toString();
     }
     track_add_wpt(trk_head, trkpt);
   }
@@ -356,14 +413,26 @@ void KmlFormat::gx_trk_coord(const QString& args, const QXmlStreamAttributes* /*
     gbFatal("gx_trk_coord: invalid kml file\n");
   }
 
-  double lat;
-  double lon;
-  double alt;
-  int n = sscanf(CSTR(args), "%lf %lf %lf", &lon, &lat, &alt);
-  if (EOF != n && 2 != n && 3 != n) {
+  // Whitespace separated "lon lat [alt]", extra trailing fields are ignored.
+  double coords[3] = {0.0, 0.0, 0.0};
+  QStringView text(args);
+  qsizetype pos = 0;
+  QStringView field;
+  int n = 0;
+  bool present = false;
+  while ((n < 3) && next_coord_token(text, pos, field)) {
+    present = true;
+    bool ok;
+    coords[n] = field.toDouble(&ok);
+    if (!ok) {
+      break;
+    }
+    ++n;
+  }
+  if (present && 2 != n && 3 != n) {
     gbFatal("coord field decode failure on \"%s\".\n", gbLogCStr(args));
   }
-  gx_trk_coords->append(std::make_tuple(n, lat, lon, alt));
+  gx_trk_coords->append(std::make_tuple(n, coords[1], coords[0], coords[2]));
 }
 
 void KmlFormat::rd_init(const QString& fname)
@@ -415,7 +484,7 @@ void KmlFormat::wr_init(const QString& fname)
   oqfile = new gpsbabel::File(fname);
   oqfile->open(QIODevice::WriteOnly | QIODevice::Text);
 
-  writer = new gpsbabel::XmlStreamWriter(oqfile);
+  writer = new gpsbabel::XmlStreamWriter(oqfile->device());
   writer->setAutoFormattingIndent(2);
 }
 
@@ -29,8 +29,10 @@
 #include <QList>                       // for QList
 #include <QString>                     // for QString, QStringLiteral, operator+, operator!=
 #include <QStringList>                 // for QStringList
+#include <QStringView>                 // for QStringView
 #include <QVector>                     // for QVector
 #include <QXmlStreamAttributes>        // for QXmlStreamAttributes
+#include <QtGlobal>                    // for qsizetype
 
 #include "defs.h"
 #include "format.h"
@@ -131,6 +133,8 @@ private:
   void wpt_desc(const QString& args, const QXmlStreamAttributes* attrs);
   void wpt_coord(const QString& args, const QXmlStreamAttributes* attrs);
   void wpt_icon(const QString& args, const QXmlStreamAttributes* attrs);
+  static bool next_coord_token(QStringView text, qsizetype& pos, QStringView& token);
+  static int split_coord_tuple(QStringView tuple, double (&coords)[3]);
   void trk_coord(const QString& args, const QXmlStreamAttributes* attrs);
   void wpt_time(const QString& args, const QXmlStreamAttributes* attrs);
   void wpt_ts_begin(const QString& args, const QXmlStreamAttributes* attrs);
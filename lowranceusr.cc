@@ -87,6 +87,7 @@
 
 #include "lowranceusr.h"
 
+#include <algorithm>            // for min
 #include <cinttypes>            // for PRId64
 #include <cmath>                // for round, atan, exp, log, tan
 #include <cstdio>               // for SEEK_CUR
@@ -98,6 +99,7 @@
 #include <QByteArray>           // for QByteArray
 #include <QDate>                // for QDate
 #include <QDateTime>            // for QDateTime
+#include <QHash>                // for QHash
 #include <QList>                // for QList
 #include <QScopedPointer>       // for QScopedPointer
 #include <QString>              // for QString, operator+, operator==, operator!=
@@ -121,22 +123,13 @@ extern WaypointList* global_waypoint_list;
 /* below couple of functions mostly borrowed from raymarine.c */
 
 /* make waypoint shortnames unique */
-bool
-LowranceusrFormat::same_points(const Waypoint* A, const Waypoint* B)
-{
-  return ( /* !!! We are case-sensitive !!! */
-           (A->shortname == B->shortname) &&
-           (A->latitude == B->latitude) &&
-           (A->longitude == B->longitude));
-}
-
 void
 LowranceusrFormat::register_waypt(const Waypoint* wpt)
 {
-  for (const Waypoint* cmp : std::as_const(*waypt_table)) {
-    if (same_points(wpt, cmp)) {
-      return;
-    }
+  /* !!! We are case-sensitive !!! */
+  WayptKey key{wpt->shortname, wpt->latitude, wpt->longitude};
+  if (waypt_table_keys.contains(key)) {
+    return;
   }
 
   if (global_opts.debug_level >= 2) {
@@ -144,24 +137,49 @@ LowranceusrFormat::register_waypt(const Waypoint* wpt)
            gbLogCStr(wpt->shortname), gbLogCStr(wpt->description), QByteArray::number(waypt_table->size()).constData());
   }
 
+  waypt_table_keys.insert(key);
+  if (!waypt_table_names.contains(wpt->shortname)) {
+    waypt_table_names.insert(wpt->shortname, waypt_table->size());
+  }
   waypt_table->append(wpt);
 }
 
 /* end borrowed from raymarine.c */
 
-const Waypoint*
-LowranceusrFormat::lowranceusr4_find_waypt(uint uid_unit, int uid_seq_low, int uid_seq_high)
+/*
+ * Route legs refer to waypoints by uid or UUID.  Index the waypoints
+ * once rather than searching the waypoint list for every leg.
+ * Like a search of the list the first waypoint with a given id wins.
+ */
+void
+LowranceusrFormat::lowranceusr4_index_waypts()
 {
-  // Iterate with waypt_disp_all?
+  uid_index.clear();
+  uuid_index.clear();
+  uid_index.reserve(global_waypoint_list->count());
+  uuid_index.reserve(global_waypoint_list->count());
   for (const Waypoint* waypointp : std::as_const(*global_waypoint_list)) {
     const auto* fs = reinterpret_cast<lowranceusr4_fsdata*>(waypointp->fs.FsChainFind(kFsLowranceusr4));
 
-    if (fs && fs->uid_unit == uid_unit &&
-        fs->uid_seq_low == uid_seq_low &&
-        fs->uid_seq_high == uid_seq_high) {
-      return waypointp;
+    if (fs) {
+      const Lowranceusr4Uid uid{fs->uid_unit, fs->uid_seq_low, fs->uid_seq_high};
+      if (!uid_index.contains(uid)) {
+        uid_index.insert(uid, waypointp);
+      }
+      const Lowranceusr4Uuid uuid{fs->UUID1, fs->UUID2, fs->UUID3, fs->UUID4};
+      if (!uuid_index.contains(uuid)) {
+        uuid_index.insert(uuid, waypointp);
+      }
     }
   }
+}
+
+const Waypoint*
+LowranceusrFormat::lowranceusr4_find_waypt(uint uid_unit, int uid_seq_low, int uid_seq_high) const
+{
+  if (const Waypoint* waypointp = uid_index.value({uid_unit, uid_seq_low, uid_seq_high}); waypointp) {
+    return waypointp;
+  }
 
   if (global_opts.debug_level >= 1) {
     gbDebug("lowranceusr4_find_waypt: warning, failed finding waypoint with ids %u %d %d\n",
@@ -171,18 +189,10 @@ LowranceusrFormat::lowranceusr4_find_waypt(uint uid_unit, int uid_seq_low, int u
 }
 
 const Waypoint*
-LowranceusrFormat::lowranceusr4_find_global_waypt(uint id1, uint id2, uint id3, uint id4)
+LowranceusrFormat::lowranceusr4_find_global_waypt(uint id1, uint id2, uint id3, uint id4) const
 {
-  // Iterate with waypt_disp_all?
-  for (const Waypoint* waypointp : std::as_const(*global_waypoint_list)) {
-    const auto* fs = reinterpret_cast<lowranceusr4_fsdata*>(waypointp->fs.FsChainFind(kFsLowranceusr4));
-
-    if (fs && fs->UUID1 == id1 &&
-        fs->UUID2 == id2 &&
-        fs->UUID3 == id3 &&
-        fs->UUID4 == id4) {
-      return waypointp;
-    }
+  if (const Waypoint* waypointp = uuid_index.value({id1, id2, id3, id4}); waypointp) {
+    return waypointp;
   }
 
   if (global_opts.debug_level >= 1) {
@@ -336,6 +346,8 @@ LowranceusrFormat::rd_deinit()
 {
   gbfclose(file_in);
   utf16le_codec = nullptr;
+  uid_index.clear();
+  uuid_index.clear();
 }
 
 void
@@ -350,6 +362,8 @@ LowranceusrFormat::wr_init(const QString& fname)
   }
   utf16le_codec = QTextCodec::codecForName("UTF-16LE");
   waypt_table = new QList<const Waypoint*>;
+  waypt_table_keys.clear();
+  waypt_table_names.clear();
 }
 
 void
@@ -361,6 +375,8 @@ LowranceusrFormat::wr_deinit()
   utf16le_codec = nullptr;
   delete waypt_table;
   waypt_table = nullptr;
+  waypt_table_keys.clear();
+  waypt_table_names.clear();
 }
 
 /**
@@ -657,6 +673,7 @@ LowranceusrFormat::lowranceusr_parse_waypts()
   if (global_opts.debug_level >= 1) {
     gbDebug("parse_waypts: Num Waypoints = %d\n", NumWaypoints);
   }
+  waypt_reserve(waypt_count() + std::min(NumWaypoints, kMaxReserve));
 
   if (global_opts.debug_level == 99) {
     if (reading_version > 3) {
@@ -751,6 +768,7 @@ LowranceusrFormat::lowranceusr_parse_route()
   }
 
   /* waypoints */
+  rte_head->waypoint_list.reserve(num_legs);
   for (int j = 0; j < num_legs; j++) {
     auto* wpt_tmp = new Waypoint;
     if (global_opts.debug_level == 99) {
@@ -819,6 +837,7 @@ LowranceusrFormat::lowranceusr4_parse_route()
     }
   }
 
+  rte_head->waypoint_list.reserve(std::min(num_legs, kMaxReserve));
   if (reading_version <= 4) {
     /* Use UID based sequence numbers for route */
     for (int j = 0; j < num_legs; ++j) {
@@ -884,6 +903,10 @@ LowranceusrFormat::lowranceusr_parse_routes()
     gbDebug("parse_routes: Num Routes = %d\n", num_routes);
   }
 
+  if (reading_version >= 4) {
+    lowranceusr4_index_waypts();
+  }
+
   for (int i = 0; i < num_routes; i++) {
     rte_head = new route_head;
     route_add_head(rte_head);
@@ -974,6 +997,7 @@ LowranceusrFormat::lowranceusr_parse_trail(int* trail_num)
   }
 
   if (num_trail_points) {
+    trk_head->waypoint_list.reserve(num_trail_points);
 
     while (num_trail_points && !gbfeof(file_in)) {
       /* num section points */
@@ -1118,6 +1142,7 @@ LowranceusrFormat::lowranceusr4_parse_trail(int* trail_num)
       gbDebug("parse_trails: -------------- -------------- -- -------- -- -------- -- --------\n");
     }
   }
+  trk_head->waypoint_list.reserve(std::min(num_trail_pts, kMaxReserve));
   for (int j = 0; j < num_trail_pts; ++j) {
     auto* wpt_tmp = new Waypoint;
 
@@ -1660,24 +1685,22 @@ LowranceusrFormat::lowranceusr4_route_hdr(const route_head* rte)
 void
 LowranceusrFormat::lowranceusr4_route_leg_disp(const Waypoint* wpt)
 {
-  for (int i = 0; i < waypt_table->size(); i++) {
+  if (auto it = waypt_table_names.constFind(wpt->shortname); it != waypt_table_names.cend()) {
+    const int i = *it;
     const Waypoint* cmp = waypt_table->at(i);
-    if (cmp->shortname == wpt->shortname) {
-      const auto* fs = reinterpret_cast<lowranceusr4_fsdata*>(cmp->fs.FsChainFind(kFsLowranceusr4));
+    const auto* fs = reinterpret_cast<lowranceusr4_fsdata*>(cmp->fs.FsChainFind(kFsLowranceusr4));
 
-      if (opt_serialnum_i > 0) {
-        gbfputint32(opt_serialnum_i, file_out);  // use option serial number if specified
-      } else if (fs != nullptr) {
-        gbfputint32(fs->uid_unit, file_out);  // else use serial number from input if valid
-      } else {
-        gbfputint32(0, file_out);  // else Write Serial Number = 0
-      }
-      gbfputint32(i, file_out); // Sequence Low
-      gbfputint32(0, file_out); // Sequence High
-      if (global_opts.debug_level > 1) {
-        gbDebug("wrote route leg with waypt '%s'\n", gbLogCStr(wpt->shortname));
-      }
-      break;
+    if (opt_serialnum_i > 0) {
+      gbfputint32(opt_serialnum_i, file_out);  // use option serial number if specified
+    } else if (fs != nullptr) {
+      gbfputint32(fs->uid_unit, file_out);  // else use serial number from input if valid
+    } else {
+      gbfputint32(0, file_out);  // else Write Serial Number = 0
+    }
+    gbfputint32(i, file_out); // Sequence Low
+    gbfputint32(0, file_out); // Sequence High
+    if (global_opts.debug_level > 1) {
+      gbDebug("wrote route leg with waypt '%s'\n", gbLogCStr(wpt->shortname));
     }
   }
 }
@@ -88,10 +88,13 @@
 #define LOWRANCEUSR_H_INCLUDED_
 
 #include <cmath>                // for round, atan, exp, log, tan
+#include <cstddef>              // for size_t
 #include <cstdint>              // for int64_t
 #include <numbers>              // for pi
 
+#include <QHash>                // for QHash, qHashMulti
 #include <QList>                // for QList
+#include <QSet>                 // for QSet
 #include <QString>              // for QString
 #include <QTextCodec>           // for QTextCodec
 #include <QVector>              // for QVector
@@ -171,6 +174,45 @@ private:
     float depth{0.0};
   };
 
+  /* Keys for the USR4 waypoint indexes, see lowranceusr4_index_waypts(). */
+  struct Lowranceusr4Uid {
+    uint unit;
+    int seq_low;
+    int seq_high;
+
+    friend bool operator==(const Lowranceusr4Uid& a, const Lowranceusr4Uid& b) = default;
+    friend size_t qHash(const Lowranceusr4Uid& key, size_t seed = 0)
+    {
+      return qHashMulti(seed, key.unit, key.seq_low, key.seq_high);
+    }
+  };
+
+  struct Lowranceusr4Uuid {
+    uint id1;
+    uint id2;
+    uint id3;
+    uint id4;
+
+    friend bool operator==(const Lowranceusr4Uuid& a, const Lowranceusr4Uuid& b) = default;
+    friend size_t qHash(const Lowranceusr4Uuid& key, size_t seed = 0)
+    {
+      return qHashMulti(seed, key.id1, key.id2, key.id3, key.id4);
+    }
+  };
+
+  /* Waypoints with the same name and position are only written once. */
+  struct WayptKey {
+    QString shortname;
+    double latitude;
+    double longitude;
+
+    friend bool operator==(const WayptKey& a, const WayptKey& b) = default;
+    friend size_t qHash(const WayptKey& key, size_t seed = 0)
+    {
+      return qHashMulti(seed, key.shortname, key.latitude, key.longitude);
+    }
+  };
+
   struct Lowranceusr4Timestamp
   {
     unsigned int julian_day_number;
@@ -387,10 +429,10 @@ private:
 
   /* Member Functions */
 
-  static bool same_points(const Waypoint* A, const Waypoint* B);
   void register_waypt(const Waypoint* wpt);
-  static const Waypoint* lowranceusr4_find_waypt(uint uid_unit, int uid_seq_low, int uid_seq_high);
-  static const Waypoint* lowranceusr4_find_global_waypt(uint id1, uint id2, uint id3, uint id4);
+  void lowranceusr4_index_waypts();
+  const Waypoint* lowranceusr4_find_waypt(uint uid_unit, int uid_seq_low, int uid_seq_high) const;
+  const Waypoint* lowranceusr4_find_global_waypt(uint id1, uint id2, uint id3, uint id4) const;
   QString lowranceusr4_readstr(gbfile* file, int bytes_per_char) const;
   void lowranceusr4_writestr(const QString& buf, gbfile* file, int bytes_per_char) const;
   static gpsbabel::DateTime lowranceusr4_get_timestamp(unsigned int jd_number, unsigned int msecs);
@@ -455,6 +497,11 @@ private:
   int            opt_serialnum_i{};
 
   QList<const Waypoint*>* waypt_table{nullptr};
+  QSet<WayptKey> waypt_table_keys;	/* the waypoints in waypt_table */
+  QHash<QString, int> waypt_table_names;	/* first waypt_table index for each shortname */
+
+  QHash<Lowranceusr4Uid, const Waypoint*> uid_index;
+  QHash<Lowranceusr4Uuid, const Waypoint*> uuid_index;
 
   unsigned short waypt_out_count{};
   int            trail_count{}, lowrance_route_count{};
@@ -92,7 +92,7 @@ load_args(const QString& filename, const QString& arg0)
 // By default Automatic Unicode detection is enabled.
   gpsbabel::File file(filename);
   file.open(QFile::ReadOnly);
-  QTextStream stream(&file);
+  QTextStream stream(file.device());
   while (!(str = stream.readLine()).isNull()) {
     str = str.trimmed();
     if ((str.isEmpty()) || (str.at(0).toLatin1() == '#')) {
@@ -54,9 +54,10 @@
 
 #include "mtk_logger.h"
 
-#include <algorithm>           // for clamp
+#include <algorithm>           // for clamp, max, min
 #include <cctype>              // for isdigit
 #include <cerrno>              // for errno
+#include <climits>             // for UINT_MAX
 #include <cmath>               // for fabs
 #include <cstdarg>             // for va_end, va_start
 #include <cstring>             // for memcmp, memset, strncmp, strlen, memmove, strchr, strcpy, strerror, strstr
@@ -80,7 +81,7 @@
 
 #include "defs.h"
 #include "gbfile.h"            // for gbfprintf, gbfputc, gbfputs, gbfclose, gbfopen, gbfile
-#include "gbser.h"             // for gbser_read_line, gbser_set_port, gbser_OK, gbser_deinit, gbser_init, gbser_print, gbser_TIMEOUT
+#include "gbser.h"             // for gbser_read_line, gbser_set_port, gbser_OK, gbser_deinit, gbser_init, gbser_print, gbser_TIMEOUT, gbser_ERROR, gbser_wait
 #include "src/core/datetime.h" // for DateTime
 #include "src/core/logging.h"  // for Fatal, Warning
 
@@ -112,11 +113,16 @@ void MtkLoggerBase::dbg(int l, const char* msg, ...)
 // Returns a fully qualified pathname to a temporary file that is a copy
 // of the data downloaded from the device. Only two copies are ever in play,
 // the primary (e.g. "/tmp/data.bin") and the backup ("/tmp/data_old.bin").
+// With the cache option the primary is the cache file and the backup sits
+// next to it, so every logger can keep its own image between downloads.
 //
 // It returns a temporary C string - it's totally kludged in to replace
 // TEMP_DATA_BIN being string constants.
-QString MtkLoggerBase::GetTempName(bool backup)
+QString MtkLoggerBase::GetTempName(bool backup) const
 {
+  if (OPT_cache) {
+    return backup ? OPT_cache.get() + ".old" : OPT_cache.get();
+  }
   const char kData[]= "data.bin";
   const char kDataBackup[]= "data_old.bin";
   return QDir::tempPath() + QDir::separator() + (backup ? kDataBackup : kData);
@@ -386,12 +392,21 @@ void MtkLoggerBase::mtk_read()
     fusage = nullptr;
   }
 
-  QThread::usleep(10 * 1000);
   if (true || log_enabled) {
     i = do_cmd(CMD_LOG_DISABLE, "PMTK001,182,5,3", nullptr, 2);
+    if (i != 0) {
+      // No ack.  If the device is still sending, ask once more,
+      // a silent device won't answer a second time either.
+      int rc = gbser_wait(fd, UINT_MAX, 0x0A, 100);
+      if (rc == gbser_ERROR) {
+        gbFatal("Read error while disabling the log\n");
+      }
+      if (rc > 0) {
+        i = do_cmd(CMD_LOG_DISABLE, "PMTK001,182,5,3", nullptr, 2);
+      }
+    }
     dbg(3, " ---- LOG DISABLE ---- %s\n", i==0?"Success":"Fail");
   }
-  QThread::usleep(100 * 1000);
 
   unsigned int addr_max = 0;
   // get flash usage, current log address..cmd only works if log disabled.
@@ -447,6 +462,7 @@ void MtkLoggerBase::mtk_read()
   int retry_cnt = 0;
 
   while (init_scan || addr < addr_max) {
+mtk_request:
     // generate - read address NMEA command, add crc.
     unsigned char crc = 0;
     int cmdLen = snprintf(cmd, sizeof(cmd), "$PMTK182,7,%.8x,%.8x", addr, bsize);
@@ -466,6 +482,12 @@ mtk_retry:
         if (rc == gbser_TIMEOUT && retry_cnt < 3) {
           dbg(2, "\nRetry %d at 0x%.8x\n", retry_cnt, addr);
           retry_cnt++;
+          if (!init_scan && bsize > scan_bsize) {
+            // A lossy link has better odds with smaller blocks.
+            bsize = std::max(bsize / 2, scan_bsize);
+            dbg(2, "Block size reduced to %d bytes\n", bsize);
+            goto mtk_request;
+          }
           goto mtk_retry;
         } // else
         gbFatal("mtk_read(): Read error (%d)\n", rc);
@@ -556,7 +578,12 @@ mtk_retry:
       if (fwrite(data, 1, rcvd_bsize, dout) != rcvd_bsize) {
         gbFatal("Failed to write temp. binary file\n");
       }
+      // Keep what we have on disk, a later download resumes from there.
+      fflush(dout);
       addr += rcvd_bsize;
+      if (bsize < read_bsize && retry_cnt == 0) {
+        bsize = std::min(bsize * 2, read_bsize);
+      }
       if (global_opts.verbose_status || (global_opts.debug_level >= 2 && global_opts.debug_level < 5)) {
         int perc = 100 - 100*(addr_max-addr)/addr_max;
         if (addr >= addr_max) {
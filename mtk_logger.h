@@ -223,6 +223,7 @@ protected:
   OptionBool OPT_log_enable;  /* enable ? command option */
   OptionString csv_file; /* csv ? command option */
   OptionInt OPT_block_size_kb; /* block_size_kb ? command option */
+  OptionString OPT_cache; /* cache ? command option */
   MTK_DEVICE_TYPE mtk_device = MTK_LOGGER;
 
   mtk_loginfo mtk_info{};
@@ -258,6 +259,10 @@ protected:
       "block_size_kb", &OPT_block_size_kb, "Size of blocks in KB to request from device",
       "1", ARGTYPE_INT, "1", "64", nullptr
     },
+    {
+      "cache", &OPT_cache, "Cache downloaded data in this file",
+      nullptr, ARGTYPE_STRING, ARG_NOMINMAX, nullptr
+    },
   };
 
   QVector<arglist_t> mtk_fargs = {
@@ -272,7 +277,7 @@ protected:
   gbfile* cd{};
 
   [[gnu::format(printf, 2, 3)]] static void dbg(int l, const char* msg, ...);
-  static QString GetTempName(bool backup);
+  QString GetTempName(bool backup) const;
   int do_send_cmd(const char* cmd, int cmdLen);
   int do_cmd(const char* cmd, const char* expect, char** rslt, time_t timeout_sec);
   void mtk_rd_init_m241(const QString& fname);
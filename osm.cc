@@ -450,58 +450,64 @@ OsmFormat::osm_node(const QString& /*unused*/, const QXmlStreamAttributes* attrv
 }
 
 void
-OsmFormat::osm_node_tag(const QString& /*unused*/, const QXmlStreamAttributes* attrv)
+OsmFormat::osm_apply_node_tag(Waypoint* waypoint, const QString& key, const QString& value) const
 {
-  QString key;
-  QString value;
-
-  if (attrv->hasAttribute("k")) {
-    key = attrv->value("k").toString();
-  }
-  if (attrv->hasAttribute("v")) {
-    value = attrv->value("v").toString();
-  }
-
   QString str = osm_strip_html(value);
 
   if (key == QLatin1String("name")) {
-    if (wpt->shortname.isEmpty()) {
-      wpt->shortname = str;
+    if (waypoint->shortname.isEmpty()) {
+      waypoint->shortname = str;
     }
   } else if (key == QLatin1String("name:en")) {
-    wpt->shortname = str;
+    waypoint->shortname = str;
   } else if (int ikey = osm_feature_ikey(key); ikey >= 0) {
-    wpt->icon_descr = osm_feature_symbol(ikey, value);
+    waypoint->icon_descr = osm_feature_symbol(ikey, value);
   } else if (key == QLatin1String("note")) {
-    if (wpt->notes.isEmpty()) {
-      wpt->notes = str;
+    if (waypoint->notes.isEmpty()) {
+      waypoint->notes = str;
     } else {
-      wpt->notes += "; ";
-      wpt->notes += str;
+      waypoint->notes += "; ";
+      waypoint->notes += str;
     }
   } else if (key == QLatin1String("gps:hdop")) {
-    wpt->hdop = str.toFloat();
+    waypoint->hdop = str.toFloat();
   } else if (key == QLatin1String("gps:vdop")) {
-    wpt->vdop = str.toFloat();
+    waypoint->vdop = str.toFloat();
   } else if (key == QLatin1String("gps:pdop")) {
-    wpt->pdop = str.toFloat();
+    waypoint->pdop = str.toFloat();
   } else if (key == QLatin1String("gps:sat")) {
-    wpt->sat = str.toInt();
+    waypoint->sat = str.toInt();
   } else if (key == QLatin1String("gps:fix")) {
     if (str == QLatin1String("2d")) {
-      wpt->fix = fix_2d;
+      waypoint->fix = fix_2d;
     } else if (str == QLatin1String("3d")) {
-      wpt->fix = fix_3d;
+      waypoint->fix = fix_3d;
     } else if (str == QLatin1String("dgps")) {
-      wpt->fix = fix_dgps;
+      waypoint->fix = fix_dgps;
     } else if (str == QLatin1String("pps")) {
-      wpt->fix = fix_pps;
+      waypoint->fix = fix_pps;
     } else if (str == QLatin1String("none")) {
-      wpt->fix = fix_none;
+      waypoint->fix = fix_none;
     }
   }
 }
 
+void
+OsmFormat::osm_node_tag(const QString& /*unused*/, const QXmlStreamAttributes* attrv)
+{
+  QString key;
+  QString value;
+
+  if (attrv->hasAttribute("k")) {
+    key = attrv->value("k").toString();
+  }
+  if (attrv->hasAttribute("v")) {
+    value = attrv->value("v").toString();
+  }
+
+  osm_apply_node_tag(wpt, key, value);
+}
+
 void
 OsmFormat::osm_way(const QString& /*unused*/, const QXmlStreamAttributes* attrv)
 {
@@ -529,43 +535,56 @@ OsmFormat::osm_way_nd(const QString& /*unused*/, const QXmlStreamAttributes* att
   }
 }
 
+// center may be nullptr if the caller has no use for a center node.
 void
-OsmFormat::osm_way_tag(const QString& /*unused*/, const QXmlStreamAttributes* attrv)
+OsmFormat::osm_apply_way_tag(route_head* route, Waypoint* center, const QString& key, const QString& value) const
 {
-  QString key;
-  QString value;
-
-  if (attrv->hasAttribute("k")) {
-    key = attrv->value("k").toString();
-  }
-  if (attrv->hasAttribute("v")) {
-    value = attrv->value("v").toString();
-  }
-
   QString str = osm_strip_html(value);
 
   if (key == QLatin1String("name")) {
-    if (rte->rte_name.isEmpty()) {
-      rte->rte_name = str;
-      wpt->shortname = str;
+    if (route->rte_name.isEmpty()) {
+      route->rte_name = str;
+      if (center) {
+        center->shortname = str;
+      }
     }
   } else if (key == QLatin1String("name:en")) {
-    rte->rte_name = str;
+    route->rte_name = str;
 
-    wpt->shortname = str;
+    if (center) {
+      center->shortname = str;
+    }
     // The remaining cases only apply to the center node
+  } else if (center == nullptr) {
+    return;
   } else if (int ikey = osm_feature_ikey(key); ikey >= 0) {
-    wpt->icon_descr = osm_feature_symbol(ikey, value);
+    center->icon_descr = osm_feature_symbol(ikey, value);
   } else if (key == "note") {
-    if (wpt->notes.isEmpty()) {
-      wpt->notes = str;
+    if (center->notes.isEmpty()) {
+      center->notes = str;
     } else {
-      wpt->notes += "; ";
-      wpt->notes += str;
+      center->notes += "; ";
+      center->notes += str;
     }
   }
 }
 
+void
+OsmFormat::osm_way_tag(const QString& /*unused*/, const QXmlStreamAttributes* attrv)
+{
+  QString key;
+  QString value;
+
+  if (attrv->hasAttribute("k")) {
+    key = attrv->value("k").toString();
+  }
+  if (attrv->hasAttribute("v")) {
+    value = attrv->value("v").toString();
+  }
+
+  osm_apply_way_tag(rte, wpt, key, value);
+}
+
 void
 OsmFormat::osm_way_center(const QString& /*unused*/, const QXmlStreamAttributes* attrv)
 {
@@ -837,7 +856,7 @@ OsmFormat::wr_init(const QString& fname)
   ofile = new gpsbabel::File(fname);
   ofile->open(QIODevice::WriteOnly | QIODevice::Text);
 
-  fout = new gpsbabel::XmlStreamWriter(ofile);
+  fout = new gpsbabel::XmlStreamWriter(ofile->device());
   fout->setAutoFormatting(true);
   fout->setAutoFormattingIndent(2);
 
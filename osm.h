@@ -70,7 +70,7 @@ public:
   void wr_deinit() override;
   void exit() override;
 
-private:
+protected:
   /* Types */
 
   struct osm_icon_mapping_t {
@@ -90,6 +90,17 @@ private:
   int osm_feature_ikey(const QString& key) const;
   QString osm_feature_symbol(int ikey, const QString& value) const;
   static QString osm_strip_html(const QString& str);
+  void osm_apply_node_tag(Waypoint* waypoint, const QString& key, const QString& value) const;
+  void osm_apply_way_tag(route_head* route, Waypoint* center, const QString& key, const QString& value) const;
+
+  /* Data Members */
+
+  QHash<QString, int> keys;
+  QHash<QPair<int, QString>, const osm_icon_mapping_t*> values;
+
+private:
+  /* Member Functions */
+
   void osm_node_end(const QString& /* unused */, const QXmlStreamAttributes* /* unused */);
   void osm_node(const QString& /* unused */, const QXmlStreamAttributes* attrv);
   void osm_node_tag(const QString& /* unused */, const QXmlStreamAttributes* attrv);
@@ -123,8 +134,6 @@ private:
 
   QHash<QString, const Waypoint*> waypoints;
 
-  QHash<QString, int> keys;
-  QHash<QPair<int, QString>, const osm_icon_mapping_t*> values;
   QHash<QString, const osm_icon_mapping_t*> icons;
 
   gpsbabel::File* ofile{nullptr};
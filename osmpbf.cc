@@ -0,0 +1,694 @@
+/*
+
+	Support for "OpenStreetMap" PBF (protocol buffer binary) data files (.osm.pbf)
+
+	Copyright (C) 2026 Robert Lipe, robertlipe+source@gpsbabel.org
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+
+/*
+ * The file format is described at
+ * https://wiki.openstreetmap.org/wiki/PBF_Format
+ *
+ * A file is a sequence of blobs, each preceded by a BlobHeader.  The first
+ * blob is an OSMHeader, the remaining OSMData blobs hold PrimitiveBlocks.
+ * The blobs are independent of each other, so we inflate and decode batches
+ * of them on a thread pool, and then merge the decoded blocks into the global
+ * lists in file order on the main thread.  This keeps the result identical
+ * to a sequential read, and keeps all Waypoint/route_head allocation and the
+ * tag handling shared with the XML reader on the main thread.
+ */
+
+#include <algorithm>                   // for max
+#include <cstdint>                     // for uint32_t, int64_t, uint64_t
+#include <utility>                     // for move, pair
+#include <vector>                      // for vector
+
+#include <QByteArray>                  // for QByteArray
+#include <QByteArrayView>              // for QByteArrayView
+#include <QDateTime>                   // for QDateTime
+#include <QList>                       // for QList
+#include <QString>                     // for QString, operator+
+#include <QStringList>                 // for QStringList
+#include <QThread>                     // for QThread
+#include <QThreadPool>                 // for QThreadPool
+
+#include "defs.h"
+#include "gbfile.h"                    // for gbfread, gbfreadbuf, gbfclose, gbfopen_be
+#include "osmpbf.h"
+#include "src/core/logging.h"          // for FatalMsg
+
+
+const QStringList OsmPbfFormat::supported_features = {
+  "OsmSchema-V0.6",
+  "DenseNodes",
+};
+
+/*******************************************************************************/
+/*                           protocol buffer decoding                          */
+/*-----------------------------------------------------------------------------*/
+
+bool
+OsmPbfFormat::PbfMessage::next()
+{
+  if (at_end()) {
+    return false;
+  }
+  uint64_t key = varint();
+  if (bad_) {
+    return false;
+  }
+  field_ = key >> 3;
+  wire_type_ = key & 0x07;
+  return true;
+}
+
+uint64_t
+OsmPbfFormat::PbfMessage::varint()
+{
+  uint64_t result = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (p_ >= end_) {
+      break;
+    }
+    unsigned char b = *p_++;
+    result |= static_cast<uint64_t>(b & 0x7f) << shift;
+    if ((b & 0x80) == 0) {
+      return result;
+    }
+  }
+  bad_ = true;
+  return 0;
+}
+
+QByteArrayView
+OsmPbfFormat::PbfMessage::bytes()
+{
+  if (wire_type_ != kWireLengthDelimited) {
+    bad_ = true;
+    return {};
+  }
+  uint64_t len = varint();
+  if (bad_ || (len > static_cast<uint64_t>(end_ - p_))) {
+    bad_ = true;
+    return {};
+  }
+  QByteArrayView result(reinterpret_cast<const char*>(p_), static_cast<qsizetype>(len));
+  p_ += len;
+  return result;
+}
+
+void
+OsmPbfFormat::PbfMessage::skip()
+{
+  switch (wire_type_) {
+  case kWireVarint:
+    (void) varint();
+    break;
+  case kWireFixed64:
+  case kWireFixed32: {
+    qsizetype len = (wire_type_ == kWireFixed64) ? 8 : 4;
+    if ((end_ - p_) < len) {
+      bad_ = true;
+    } else {
+      p_ += len;
+    }
+    break;
+  }
+  case kWireLengthDelimited:
+    (void) bytes();
+    break;
+  default:
+    bad_ = true;
+    break;
+  }
+}
+
+/*******************************************************************************/
+/*                                 blob handling                               */
+/*-----------------------------------------------------------------------------*/
+
+bool
+OsmPbfFormat::read_blob(PbfBlob& blob)
+{
+  unsigned char size_buf[4];
+  gbsize_t cnt = gbfread(size_buf, 1, sizeof(size_buf), fin);
+  if (cnt == 0) {
+    return false;
+  }
+  if (cnt != sizeof(size_buf)) {
+    gbFatal("Truncated BlobHeader size in \"%s\".\n", gbLogCStr(fin->name));
+  }
+  auto header_size = static_cast<uint32_t>(be_read32(size_buf));
+  if (header_size > kMaxBlobHeaderSize) {
+    gbFatal("BlobHeader size %u exceeds limit of %u.\n", header_size, kMaxBlobHeaderSize);
+  }
+
+  QByteArray header = gbfreadbuf(header_size, fin);
+  blob.type.clear();
+  uint64_t data_size = 0;
+  PbfMessage msg(header);
+  while (msg.next()) {
+    switch (msg.field()) {
+    case 1:	/* type */
+      blob.type = msg.bytes().toByteArray();
+      break;
+    case 3:	/* datasize */
+      data_size = msg.varint();
+      break;
+    default:
+      msg.skip();
+      break;
+    }
+  }
+  if (msg.bad()) {
+    gbFatal("Invalid BlobHeader in \"%s\".\n", gbLogCStr(fin->name));
+  }
+  if (data_size > kMaxBlobSize) {
+    gbFatal("Blob size %llu exceeds limit of %u.\n", static_cast<unsigned long long>(data_size), kMaxBlobSize);
+  }
+
+  blob.data = gbfreadbuf(data_size, fin);
+  return true;
+}
+
+bool
+OsmPbfFormat::inflate_blob(const QByteArray& blob, QByteArray& raw, QString& error)
+{
+  QByteArrayView zlib_data;
+  uint64_t raw_size = 0;
+  bool have_raw = false;
+
+  PbfMessage msg(blob);
+  while (msg.next()) {
+    switch (msg.field()) {
+    case 1:	/* raw */
+      raw = msg.bytes().toByteArray();
+      have_raw = true;
+      break;
+    case 2:	/* raw_size */
+      raw_size = msg.varint();
+      break;
+    case 3:	/* zlib_data */
+      zlib_data = msg.bytes();
+      break;
+    case 4:	/* lzma_data */
+    case 5:	/* OBSOLETE_bzip2_data */
+    case 6:	/* lz4_data */
+    case 7:	/* zstd_data */
+      error = QStringLiteral("Unsupported blob compression (field %1)").arg(msg.field());
+      return false;
+    default:
+      msg.skip();
+      break;
+    }
+  }
+  if (msg.bad()) {
+    error = QStringLiteral("Invalid Blob");
+    return false;
+  }
+  if (have_raw) {
+    return true;
+  }
+  if (zlib_data.isNull()) {
+    error = QStringLiteral("Blob has no data");
+    return false;
+  }
+  if (raw_size > kMaxBlobSize) {
+    error = QStringLiteral("Uncompressed blob size %1 exceeds limit of %2").arg(raw_size).arg(kMaxBlobSize);
+    return false;
+  }
+
+#if !ZLIB_INHIBITED
+  raw.resize(static_cast<qsizetype>(raw_size));
+  auto dest_len = static_cast<uLongf>(raw_size);
+  int rc = uncompress(reinterpret_cast<Bytef*>(raw.data()), &dest_len,
+                      reinterpret_cast<const Bytef*>(zlib_data.data()),
+                      static_cast<uLong>(zlib_data.size()));
+  if ((rc != Z_OK) || (dest_len != raw_size)) {
+    error = QStringLiteral("Cannot inflate blob (zlib error %1)").arg(rc);
+    return false;
+  }
+  return true;
+#else
+  error = QStringLiteral("No zlib support");
+  return false;
+#endif
+}
+
+void
+OsmPbfFormat::decode_header(const PbfBlob& blob) const
+{
+  QByteArray raw;
+  QString error;
+  if (!inflate_blob(blob.data, raw, error)) {
+    gbFatal("%s in \"%s\".\n", gbLogCStr(error), gbLogCStr(fin->name));
+  }
+
+  PbfMessage msg(raw);
+  while (msg.next()) {
+    if (msg.field() == 4) {	/* required_features */
+      QString feature = QString::fromUtf8(msg.bytes());
+      if (!supported_features.contains(feature)) {
+        gbFatal("Unsupported required feature \"%s\" in \"%s\".\n",
+                gbLogCStr(feature), gbLogCStr(fin->name));
+      }
+    } else {
+      msg.skip();
+    }
+  }
+  if (msg.bad()) {
+    gbFatal("Invalid OSMHeader in \"%s\".\n", gbLogCStr(fin->name));
+  }
+}
+
+/*******************************************************************************/
+/*                           PrimitiveBlock decoding                           */
+/*          These run on the thread pool and must not touch any globals.       */
+/*-----------------------------------------------------------------------------*/
+
+bool
+OsmPbfFormat::decode_packed_delta(QByteArrayView data, std::vector<int64_t>& values)
+{
+  int64_t value = 0;
+  PbfMessage packed(data);
+  while (!packed.at_end()) {
+    value += packed.svarint();
+    values.push_back(value);
+  }
+  return !packed.bad();
+}
+
+bool
+OsmPbfFormat::decode_tags(QByteArrayView keys, QByteArrayView vals, qsizetype nstrings,
+                          std::vector<std::pair<uint32_t, uint32_t>>& tags)
+{
+  PbfMessage kmsg(keys);
+  PbfMessage vmsg(vals);
+  while (!kmsg.at_end() && !vmsg.at_end()) {
+    uint64_t k = kmsg.varint();
+    uint64_t v = vmsg.varint();
+    if ((k >= static_cast<uint64_t>(nstrings)) || (v >= static_cast<uint64_t>(nstrings))) {
+      return false;
+    }
+    tags.emplace_back(k, v);
+  }
+  return !kmsg.bad() && !vmsg.bad() && kmsg.at_end() && vmsg.at_end();
+}
+
+bool
+OsmPbfFormat::decode_dense_nodes(QByteArrayView data, const PbfScale& scale, PbfBlock& block)
+{
+  std::vector<int64_t> ids;
+  std::vector<int64_t> lats;
+  std::vector<int64_t> lons;
+  std::vector<int64_t> timestamps;
+  QByteArrayView keys_vals;
+
+  PbfMessage msg(data);
+  while (msg.next()) {
+    switch (msg.field()) {
+    case 1:	/* id, delta coded */
+      if (!decode_packed_delta(msg.bytes(), ids)) {
+        return false;
+      }
+      break;
+    case 5: {	/* denseinfo */
+      PbfMessage info(msg.bytes());
+      while (info.next()) {
+        if (info.field() == 2) {	/* timestamp, delta coded */
+          if (!decode_packed_delta(info.bytes(), timestamps)) {
+            return false;
+          }
+        } else {
+          info.skip();
+        }
+      }
+      if (info.bad()) {
+        return false;
+      }
+      break;
+    }
+    case 8:	/* lat, delta coded */
+      if (!decode_packed_delta(msg.bytes(), lats)) {
+        return false;
+      }
+      break;
+    case 9:	/* lon, delta coded */
+      if (!decode_packed_delta(msg.bytes(), lons)) {
+        return false;
+      }
+      break;
+    case 10:	/* keys_vals */
+      keys_vals = msg.bytes();
+      break;
+    default:
+      msg.skip();
+      break;
+    }
+  }
+  if (msg.bad() || (lats.size() != ids.size()) || (lons.size() != ids.size()) ||
+      (!timestamps.empty() && (timestamps.size() != ids.size()))) {
+    return false;
+  }
+
+  /*
+   * keys_vals holds the tags of all nodes as (key, value) string table
+   * index pairs, each node's list being terminated by a 0.  It is empty
+   * if none of the nodes in the block have tags.
+   */
+  PbfMessage kv(keys_vals);
+  const auto nstrings = static_cast<uint64_t>(block.strings.size());
+  block.nodes.reserve(block.nodes.size() + ids.size());
+  for (std::size_t i = 0; i < ids.size(); ++i) {
+    PbfNode node;
+    node.id = ids[i];
+    node.lat = scale.lat_offset + (scale.granularity * lats[i]);
+    node.lon = scale.lon_offset + (scale.granularity * lons[i]);
+    if (!timestamps.empty()) {
+      node.timestamp = timestamps[i] * scale.date_granularity;
+    }
+    while (!kv.at_end()) {
+      uint64_t k = kv.varint();
+      if (k == 0) {
+        break;
+      }
+      uint64_t v = kv.varint();
+      if ((k >= nstrings) || (v >= nstrings)) {
+        return false;
+      }
+      node.tags.emplace_back(k, v);
+    }
+    block.nodes.push_back(std::move(node));
+  }
+  return !kv.bad();
+}
+
+bool
+OsmPbfFormat::decode_node(QByteArrayView data, const PbfScale& scale, PbfBlock& block)
+{
+  PbfNode node;
+  QByteArrayView keys;
+  QByteArrayView vals;
+
+  PbfMessage msg(data);
+  while (msg.next()) {
+    switch (msg.field()) {
+    case 1:	/* id */
+      node.id = msg.svarint();
+      break;
+    case 2:	/* keys */
+      keys = msg.bytes();
+      break;
+    case 3:	/* vals */
+      vals = msg.bytes();
+      break;
+    case 4: {	/* info */
+      PbfMessage info(msg.bytes());
+      while (info.next()) {
+        if (info.field() == 2) {	/* timestamp */
+          node.timestamp = static_cast<int64_t>(info.varint()) * scale.date_granularity;
+        } else {
+          info.skip();
+        }
+      }
+      if (info.bad()) {
+        return false;
+      }
+      break;
+    }
+    case 8:	/* lat */
+      node.lat = scale.lat_offset + (scale.granularity * msg.svarint());
+      break;
+    case 9:	/* lon */
+      node.lon = scale.lon_offset + (scale.granularity * msg.svarint());
+      break;
+    default:
+      msg.skip();
+      break;
+    }
+  }
+  if (msg.bad() || !decode_tags(keys, vals, block.strings.size(), node.tags)) {
+    return false;
+  }
+  block.nodes.push_back(std::move(node));
+  return true;
+}
+
+bool
+OsmPbfFormat::decode_way(QByteArrayView data, PbfBlock& block)
+{
+  PbfWay way;
+  QByteArrayView keys;
+  QByteArrayView vals;
+
+  PbfMessage msg(data);
+  while (msg.next()) {
+    switch (msg.field()) {
+    case 1:	/* id */
+      way.id = static_cast<int64_t>(msg.varint());
+      break;
+    case 2:	/* keys */
+      keys = msg.bytes();
+      break;
+    case 3:	/* vals */
+      vals = msg.bytes();
+      break;
+    case 8:	/* refs, delta coded */
+      if (!decode_packed_delta(msg.bytes(), way.refs)) {
+        return false;
+      }
+      break;
+    default:
+      msg.skip();
+      break;
+    }
+  }
+  if (msg.bad() || !decode_tags(keys, vals, block.strings.size(), way.tags)) {
+    return false;
+  }
+  block.ways.push_back(std::move(way));
+  return true;
+}
+
+bool
+OsmPbfFormat::decode_primitive_group(QByteArrayView data, const PbfScale& scale, PbfBlock& block)
+{
+  PbfMessage msg(data);
+  while (msg.next()) {
+    bool ok = true;
+    switch (msg.field()) {
+    case 1:	/* nodes */
+      ok = decode_node(msg.bytes(), scale, block);
+      break;
+    case 2:	/* dense */
+      ok = decode_dense_nodes(msg.bytes(), scale, block);
+      break;
+    case 3:	/* ways */
+      ok = decode_way(msg.bytes(), block);
+      break;
+    default:	/* relations and changesets are ignored */
+      msg.skip();
+      break;
+    }
+    if (!ok) {
+      return false;
+    }
+  }
+  return !msg.bad();
+}
+
+void
+OsmPbfFormat::decode_block(const PbfBlob& blob, PbfBlock& block)
+{
+  QByteArray raw;
+  if (!inflate_blob(blob.data, raw, block.error)) {
+    return;
+  }
+
+  /*
+   * The string table has to be known before the groups can be decoded,
+   * but the schema doesn't constrain the field order.
+   */
+  PbfScale scale;
+  QList<QByteArrayView> groups;
+  PbfMessage msg(raw);
+  while (msg.next()) {
+    switch (msg.field()) {
+    case 1: {	/* stringtable */
+      PbfMessage table(msg.bytes());
+      while (table.next()) {
+        if (table.field() == 1) {
+          block.strings.append(QString::fromUtf8(table.bytes()));
+        } else {
+          table.skip();
+        }
+      }
+      if (table.bad()) {
+        block.error = QStringLiteral("Invalid StringTable");
+        return;
+      }
+      break;
+    }
+    case 2:	/* primitivegroup */
+      groups.append(msg.bytes());
+      break;
+    case 17:	/* granularity */
+      scale.granularity = static_cast<int64_t>(msg.varint());
+      break;
+    case 18:	/* date_granularity */
+      scale.date_granularity = static_cast<int64_t>(msg.varint());
+      break;
+    case 19:	/* lat_offset */
+      scale.lat_offset = static_cast<int64_t>(msg.varint());
+      break;
+    case 20:	/* lon_offset */
+      scale.lon_offset = static_cast<int64_t>(msg.varint());
+      break;
+    default:
+      msg.skip();
+      break;
+    }
+  }
+  if (msg.bad()) {
+    block.error = QStringLiteral("Invalid PrimitiveBlock");
+    return;
+  }
+
+  for (const auto& group : std::as_const(groups)) {
+    if (!decode_primitive_group(group, scale, block)) {
+      block.error = QStringLiteral("Invalid PrimitiveGroup");
+      return;
+    }
+  }
+}
+
+/*******************************************************************************/
+/*                                    READER                                   */
+/*-----------------------------------------------------------------------------*/
+
+void
+OsmPbfFormat::merge_block(const PbfBlock& block)
+{
+  waypt_reserve(waypt_count() + block.nodes.size());
+  for (const auto& node : block.nodes) {
+    auto* wpt = new Waypoint;
+    QString atstr = QString::number(node.id);
+    wpt->description = "osm-id " + atstr;
+    wpt->latitude = node.lat / 1e9;
+    wpt->longitude = node.lon / 1e9;
+    if (node.timestamp != 0) {
+      wpt->creation_time = QDateTime::fromMSecsSinceEpoch(node.timestamp, QtUTC);
+    }
+    for (const auto& [k, v] : node.tags) {
+      osm_apply_node_tag(wpt, block.strings.at(k), block.strings.at(v));
+    }
+
+    if (nodes.contains(node.id)) {
+      gbWarning("Duplicate osm-id %s!\n", gbLogCStr(atstr));
+      delete wpt;
+    } else {
+      nodes.insert(node.id, wpt);
+      waypt_add(wpt);
+    }
+  }
+
+  for (const auto& way : block.ways) {
+    auto* rte = new route_head;
+    rte->rte_desc = "osm-id " + QString::number(way.id);
+    QList<Waypoint*> rtepts;
+    rtepts.reserve(way.refs.size());
+    for (const auto ref : way.refs) {
+      if (const Waypoint* ctmp = nodes.value(ref); ctmp != nullptr) {
+        rtepts.append(new Waypoint(*ctmp));
+      } else {
+        gbWarning("Way reference id \"%lld\" wasn't listed under nodes!\n", static_cast<long long>(ref));
+      }
+    }
+    route_add_wpts(rte, rtepts);
+    for (const auto& [k, v] : way.tags) {
+      osm_apply_way_tag(rte, nullptr, block.strings.at(k), block.strings.at(v));
+    }
+    route_add_head(rte);
+  }
+}
+
+void
+OsmPbfFormat::rd_init(const QString& fname)
+{
+  nodes.clear();
+  if (keys.isEmpty()) {
+    osm_features_init();
+  }
+
+  fin = gbfopen_be(fname, "rb");
+}
+
+void
+OsmPbfFormat::read()
+{
+  const auto batch_size = static_cast<std::size_t>(2 * std::max(1, QThread::idealThreadCount()));
+  QThreadPool pool;
+  bool have_header = false;
+  bool eof = false;
+
+  while (!eof) {
+    std::vector<PbfBlob> blobs;
+    while (blobs.size() < batch_size) {
+      PbfBlob blob;
+      if (!read_blob(blob)) {
+        eof = true;
+        break;
+      }
+      if (blob.type == "OSMHeader") {
+        decode_header(blob);
+        have_header = true;
+      } else if (blob.type == "OSMData") {
+        if (!have_header) {
+          gbFatal("OSMData blob before OSMHeader in \"%s\".\n", gbLogCStr(fin->name));
+        }
+        blobs.push_back(std::move(blob));
+      }
+      // Unknown blob types are skipped as required by the specification.
+    }
+
+    std::vector<PbfBlock> blocks(blobs.size());
+    for (std::size_t i = 0; i < blobs.size(); ++i) {
+      const PbfBlob* blob = &blobs[i];
+      PbfBlock* block = &blocks[i];
+      pool.start([blob, block]() {
+        decode_block(*blob, *block);
+      });
+    }
+    pool.waitForDone();
+
+    for (const auto& block : blocks) {
+      if (!block.error.isEmpty()) {
+        gbFatal("%s in \"%s\".\n", gbLogCStr(block.error), gbLogCStr(fin->name));
+      }
+      merge_block(block);
+    }
+  }
+}
+
+void
+OsmPbfFormat::rd_deinit()
+{
+  gbfclose(fin);
+  fin = nullptr;
+  nodes.clear();
+}
@@ -0,0 +1,190 @@
+/*
+
+	Support for "OpenStreetMap" PBF (protocol buffer binary) data files (.osm.pbf)
+
+	Copyright (C) 2026 Robert Lipe, robertlipe+source@gpsbabel.org
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+*/
+#ifndef OSMPBF_H_INCLUDED_
+#define OSMPBF_H_INCLUDED_
+
+#include <cstdint>                     // for uint32_t, uint64_t, int64_t
+#include <utility>                     // for pair
+#include <vector>                      // for vector
+
+#include <QByteArray>                  // for QByteArray
+#include <QByteArrayView>              // for QByteArrayView
+#include <QHash>                       // for QHash
+#include <QList>                       // for QList
+#include <QString>                     // for QString
+#include <QStringList>                 // for QStringList
+#include <QVector>                     // for QVector
+
+#include "defs.h"
+#include "gbfile.h"                    // for gbfile
+#include "osm.h"                       // for OsmFormat
+
+
+/*
+ * The PBF reader shares the feature/icon tables and the tag handling
+ * of the XML reader, so it is implemented as a read only variant of OsmFormat.
+ */
+class OsmPbfFormat : public OsmFormat
+{
+public:
+  /* Member Functions */
+
+  QVector<arglist_t>* get_args() override
+  {
+    return nullptr;
+  }
+
+  ff_type get_type() const override
+  {
+    return ff_type_file;
+  }
+
+  QVector<ff_cap> get_cap() const override
+  {
+    return {
+      ff_cap_read			/* waypoints */,
+      ff_cap_none			/* tracks */,
+      ff_cap_read			/* routes */,
+    };
+  }
+
+  void rd_init(const QString& fname) override;
+  void read() override;
+  void rd_deinit() override;
+
+private:
+  /* Types */
+
+  /*
+   * A minimal protocol buffer wire format decoder.
+   * Only the wire types used by the OSM PBF schema are supported.
+   * Errors are sticky, once the decoder is bad all further reads
+   * return zero/empty values and next() returns false.
+   */
+  class PbfMessage
+  {
+  public:
+    explicit PbfMessage(QByteArrayView data) :
+      p_(reinterpret_cast<const unsigned char*>(data.data())),
+      end_(p_ + data.size())
+    {}
+
+    bool next();
+    bool at_end() const
+    {
+      return bad_ || (p_ >= end_);
+    }
+    bool bad() const
+    {
+      return bad_;
+    }
+    uint32_t field() const
+    {
+      return field_;
+    }
+    uint32_t wire_type() const
+    {
+      return wire_type_;
+    }
+    uint64_t varint();
+    int64_t svarint()
+    {
+      uint64_t v = varint();
+      return static_cast<int64_t>((v >> 1) ^ (~(v & 1) + 1));
+    }
+    QByteArrayView bytes();
+    void skip();
+
+  private:
+    static constexpr uint32_t kWireVarint = 0;
+    static constexpr uint32_t kWireFixed64 = 1;
+    static constexpr uint32_t kWireLengthDelimited = 2;
+    static constexpr uint32_t kWireFixed32 = 5;
+
+    const unsigned char* p_;
+    const unsigned char* end_;
+    uint32_t field_{0};
+    uint32_t wire_type_{0};
+    bool bad_{false};
+  };
+
+  struct PbfBlob {
+    QByteArray type;
+    QByteArray data;
+  };
+
+  struct PbfNode {
+    int64_t id{0};
+    int64_t lat{0};	/* nanodegrees */
+    int64_t lon{0};	/* nanodegrees */
+    int64_t timestamp{0};	/* milliseconds since epoch, 0 => unknown */
+    std::vector<std::pair<uint32_t, uint32_t>> tags;	/* string table indices */
+  };
+
+  struct PbfWay {
+    int64_t id{0};
+    std::vector<std::pair<uint32_t, uint32_t>> tags;	/* string table indices */
+    std::vector<int64_t> refs;
+  };
+
+  /* PrimitiveBlock scaling parameters, defaults are from the schema. */
+  struct PbfScale {
+    int64_t granularity{100};	/* nanodegrees */
+    int64_t lat_offset{0};	/* nanodegrees */
+    int64_t lon_offset{0};	/* nanodegrees */
+    int64_t date_granularity{1000};	/* milliseconds */
+  };
+
+  struct PbfBlock {
+    QStringList strings;
+    std::vector<PbfNode> nodes;
+    std::vector<PbfWay> ways;
+    QString error;
+  };
+
+  /* Constants */
+
+  static constexpr uint32_t kMaxBlobHeaderSize = 64 * 1024;
+  static constexpr uint32_t kMaxBlobSize = 32 * 1024 * 1024;
+  static const QStringList supported_features;
+
+  /* Member Functions */
+
+  bool read_blob(PbfBlob& blob);
+  static bool inflate_blob(const QByteArray& blob, QByteArray& raw, QString& error);
+  void decode_header(const PbfBlob& blob) const;
+  static void decode_block(const PbfBlob& blob, PbfBlock& block);
+  static bool decode_primitive_group(QByteArrayView data, const PbfScale& scale, PbfBlock& block);
+  static bool decode_dense_nodes(QByteArrayView data, const PbfScale& scale, PbfBlock& block);
+  static bool decode_node(QByteArrayView data, const PbfScale& scale, PbfBlock& block);
+  static bool decode_way(QByteArrayView data, PbfBlock& block);
+  static bool decode_packed_delta(QByteArrayView data, std::vector<int64_t>& values);
+  static bool decode_tags(QByteArrayView keys, QByteArrayView vals, qsizetype nstrings,
+                          std::vector<std::pair<uint32_t, uint32_t>>& tags);
+  void merge_block(const PbfBlock& block);
+
+  /* Data Members */
+
+  gbfile* fin{nullptr};
+  QHash<int64_t, const Waypoint*> nodes;
+};
+#endif // OSMPBF_H_INCLUDED_
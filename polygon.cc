@@ -21,10 +21,18 @@
 
 #include "polygon.h"
 
+#include <algorithm>              // for min, max, minmax_element, clamp
+#include <cmath>                  // for isnan
+#include <cstddef>                // for size_t
 #include <cstdio>                 // for sscanf
+#include <utility>                // for as_const, pair
+#include <vector>                 // for vector
 
+#include <QIODevice>              // for QIODevice
 #include <QString>                // for QString
-#include <QtGlobal>               // for foreach
+#include <QThread>                // for QThread
+#include <QThreadPool>            // for QThreadPool
+#include <QtGlobal>               // for qsizetype, qint64
 
 #include "defs.h"
 #include "src/core/textstream.h"  // for TextStream
@@ -219,12 +227,16 @@ void PolygonFilter::polytest(double lat1, double lon1,
 
 #define BADVAL 999999
 
-void PolygonFilter::process()
+/*
+ * Read the polygon file into a list of sides.  A side is generated for
+ * each vertex following the first vertex of a polygon, a polygon is
+ * closed when its first vertex is repeated.
+ */
+std::vector<PolygonFilter::Edge> PolygonFilter::read_edges() const
 {
-  extra_data* ed;
+  std::vector<Edge> edges;
   int fileline = 0;
-  int first = 1;
-  int last = 0;
+  bool first = true;
   QString line;
 
   gpsbabel::TextStream stream;
@@ -252,30 +264,10 @@ void PolygonFilter::process()
               fileline);
     } else if (lat1 != BADVAL && lon1 != BADVAL &&
                lat2 != BADVAL && lon2 != BADVAL) {
-      foreach (Waypoint* waypointp, *global_waypoint_list) {
-        if (waypointp->extra_data) {
-          ed = (extra_data*) waypointp->extra_data;
-        } else {
-          ed = new extra_data;
-          ed->state = OUTSIDE;
-          ed->override = 0;
-          waypointp->extra_data = ed;
-        }
-        if (lat2 == waypointp->latitude &&
-            lon2 == waypointp->longitude) {
-          ed->override = 1;
-        }
-        if (olat != BADVAL && olon != BADVAL &&
-            olat == lat2 && olon == lon2) {
-          last = 1;
-        }
-        polytest(lat1, lon1, lat2, lon2,
-                 waypointp->latitude,
-                 waypointp->longitude,
-                 &ed->state, first, last);
-        first = 0;
-        last = 0;
-      }
+      bool last = olat != BADVAL && olon != BADVAL &&
+                  olat == lat2 && olon == lon2;
+      edges.push_back({lat1, lon1, lat2, lon2, first, last});
+      first = false;
     }
     if (olat != BADVAL && olon != BADVAL &&
         olat == lat2 && olon == lon2) {
@@ -283,7 +275,7 @@ void PolygonFilter::process()
       olon = BADVAL;
       lat1 = BADVAL;
       lon1 = BADVAL;
-      first = 1;
+      first = true;
     } else if (lat1 == BADVAL || lon1 == BADVAL) {
       olat = lat2;
       olon = lon2;
@@ -296,20 +288,154 @@ void PolygonFilter::process()
   }
   stream.close();
 
-  foreach (Waypoint* wp, *global_waypoint_list) {
-    if (wp->extra_data) {
-      ed = (extra_data*) wp->extra_data;
-      wp->extra_data = nullptr;
-      if (ed->override) {
-        ed->state = INSIDE;
+  return edges;
+}
+
+/*
+ * Bucket the edges overlapping [lat_min, lat_max] into latitude bands.
+ * Edges outside that range can't affect any test point and are dropped,
+ * which also serves as a bounding box prefilter.  Long edges appear in
+ * several bands, so the number of bands is reduced until the index stays
+ * within a small multiple of the number of edges.
+ */
+PolygonFilter::EdgeBands PolygonFilter::index_edges(const std::vector<Edge>& edges, double lat_min, double lat_max)
+{
+  EdgeBands bands;
+  bands.lat_min = lat_min;
+  bands.nbands = std::clamp(static_cast<int>(edges.size()), 1, 1 << 16);
+
+  std::vector<std::pair<int, int>> spans(edges.size(), {0, -1});
+  for (;;) {
+    bands.scale = (lat_max > lat_min) ? bands.nbands / (lat_max - lat_min) : 0.0;
+    qint64 total = 0;
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+      const Edge& e = edges[i];
+      // A side with one unusable (NaN) latitude can still touch the
+      // latitude of its other end.
+      double elat1 = std::isnan(e.lat1) ? e.lat2 : e.lat1;
+      double elat2 = std::isnan(e.lat2) ? e.lat1 : e.lat2;
+      double emin = std::min(elat1, elat2);
+      double emax = std::max(elat1, elat2);
+      if (emax >= lat_min && emin <= lat_max) {	/* false for NaN */
+        spans[i] = {bands.band(std::max(emin, lat_min)), bands.band(std::min(emax, lat_max))};
+        total += spans[i].second - spans[i].first + 1;
       }
-      if (((ed->state & INSIDE) == OUTSIDE) == !exclopt) {
-        wp->wpt_flags.marked_for_deletion = 1;
+    }
+    if ((bands.nbands == 1) || (total <= 8 * static_cast<qint64>(edges.size()))) {
+      break;
+    }
+    bands.nbands /= 2;
+  }
+
+  bands.offsets.assign(bands.nbands + 1, 0);
+  for (const auto& [b0, b1] : spans) {
+    for (int b = b0; b <= b1; ++b) {
+      ++bands.offsets[b + 1];
+    }
+  }
+  for (int b = 0; b < bands.nbands; ++b) {
+    bands.offsets[b + 1] += bands.offsets[b];
+  }
+  bands.edges.resize(bands.offsets[bands.nbands]);
+  std::vector<int> fill(bands.offsets.cbegin(), bands.offsets.cend() - 1);
+  for (std::size_t i = 0; i < edges.size(); ++i) {
+    for (int b = spans[i].first; b <= spans[i].second; ++b) {
+      bands.edges[fill[b]++] = static_cast<int>(i);
+    }
+  }
+  return bands;
+}
+
+/*
+ * Run the odd/even test for one point against the edges of its band.
+ * Edges that don't reach the point's latitude never change its state,
+ * so this is equivalent to testing the point against every edge.
+ */
+bool PolygonFilter::inside(const std::vector<Edge>& edges, const EdgeBands& bands,
+                           double wlat, double wlon)
+{
+  unsigned short state = OUTSIDE;
+  bool on_vertex = false;
+  const int b = bands.band(wlat);
+  for (int k = bands.offsets[b]; k < bands.offsets[b + 1]; ++k) {
+    const Edge& e = edges[bands.edges[k]];
+    if (e.lat2 == wlat && e.lon2 == wlon) {
+      on_vertex = true;
+    }
+    polytest(e.lat1, e.lon1, e.lat2, e.lon2, wlat, wlon,
+             &state, e.first, e.last);
+  }
+  return on_vertex || (state & INSIDE);
+}
+
+void PolygonFilter::process()
+{
+  const std::vector<Edge> edges = read_edges();
+  if (edges.empty()) {
+    return;
+  }
+
+  // Gather every point to test, so that one index and one parallel
+  // pass serve the waypoints, route points and track points alike.
+  std::vector<Waypoint*> wpts(global_waypoint_list->cbegin(), global_waypoint_list->cend());
+  if (routesopt) {
+    for (const route_head* rte : std::as_const(*global_route_list)) {
+      wpts.insert(wpts.end(), rte->waypoint_list.cbegin(), rte->waypoint_list.cend());
+    }
+  }
+  if (tracksopt) {
+    for (const route_head* rte : std::as_const(*global_track_list)) {
+      wpts.insert(wpts.end(), rte->waypoint_list.cbegin(), rte->waypoint_list.cend());
+    }
+  }
+  if (wpts.empty()) {
+    return;
+  }
+
+  const qsizetype nwpts = wpts.size();
+  std::vector<double> lats;
+  std::vector<double> lons;
+  lats.reserve(nwpts);
+  lons.reserve(nwpts);
+  for (const Waypoint* wp : wpts) {
+    lats.push_back(wp->latitude);
+    lons.push_back(wp->longitude);
+  }
+  const auto [lat_min, lat_max] = std::minmax_element(lats.cbegin(), lats.cend());
+  const EdgeBands bands = index_edges(edges, *lat_min, *lat_max);
+
+  // The test points are independent, so evaluate them in parallel.
+  const bool exclude = exclopt;
+  std::vector<unsigned char> keep(nwpts);
+  const qsizetype nchunks = std::min<qsizetype>(QThread::idealThreadCount(), (nwpts + 1023) / 1024);
+  QThreadPool pool;
+  for (qsizetype chunk = 0; chunk < nchunks; ++chunk) {
+    const qsizetype begin = nwpts * chunk / nchunks;
+    const qsizetype end = nwpts * (chunk + 1) / nchunks;
+    pool.start([&, begin, end]() {
+      for (qsizetype i = begin; i < end; ++i) {
+        keep[i] = inside(edges, bands, lats[i], lons[i]) != exclude;
       }
-      delete ed;
+    });
+  }
+  pool.waitForDone();
+
+  for (qsizetype i = 0; i < nwpts; ++i) {
+    if (!keep[i]) {
+      wpts[i]->wpt_flags.marked_for_deletion = 1;
     }
   }
   del_marked_wpts();
+  if (routesopt) {
+    for (route_head* rte : std::as_const(*global_route_list)) {
+      route_del_marked_wpts(rte);
+    }
+  }
+  if (tracksopt) {
+    for (route_head* rte : std::as_const(*global_track_list)) {
+      track_del_marked_wpts(rte);
+    }
+  }
 }
 
 #endif // FILTERS_ENABLED
@@ -22,6 +22,9 @@
 #ifndef POLYGON_H_INCLUDED_
 #define POLYGON_H_INCLUDED_
 
+#include <algorithm>  // for clamp
+#include <vector>     // for vector
+
 #include <QList>     // for QList
 #include <QString>   // for QString
 #include <QVector>   // for QVector
@@ -44,9 +47,34 @@ public:
 private:
   /* Types */
 
-  struct extra_data {
-    unsigned short state;
-    unsigned short override;
+  /* A polygon side, in the order they appear in the polygon file. */
+  struct Edge {
+    double lat1;
+    double lon1;
+    double lat2;
+    double lon2;
+    bool first;	/* first side of a polygon */
+    bool last;	/* side closing a polygon */
+  };
+
+  /*
+   * The edges grouped into latitude bands.  Only edges whose latitude
+   * range includes a test point's latitude can change its state, so a
+   * test point only needs to look at the edges of its own band.
+   * Within a band the edges keep their polygon file order.
+   */
+  struct EdgeBands {
+    double lat_min{0.0};
+    double scale{0.0};	/* bands per degree */
+    int nbands{1};
+    std::vector<int> offsets;	/* band b holds edges[offsets[b] .. offsets[b+1]) */
+    std::vector<int> edges;	/* indices into the edge list */
+
+    int band(double lat) const
+    {
+      auto b = static_cast<int>((lat - lat_min) * scale);
+      return std::clamp(b, 0, nbands - 1);
+    }
   };
 
   /* Member Functions */
@@ -55,11 +83,17 @@ private:
                 double lat2, double lon2,
                 double wlat, double wlon,
                 unsigned short* state, int first, int last);
+  std::vector<Edge> read_edges() const;
+  static EdgeBands index_edges(const std::vector<Edge>& edges, double lat_min, double lat_max);
+  static bool inside(const std::vector<Edge>& edges, const EdgeBands& bands,
+                     double wlat, double wlon);
 
   /* Data Members */
 
   OptionString polyfileopt;
   OptionBool exclopt;
+  OptionBool routesopt;
+  OptionBool tracksopt;
 
   QVector<arglist_t> args = {
     {
@@ -70,6 +104,14 @@ private:
       "exclude", &exclopt, "Exclude points inside the polygon",
       nullptr, ARGTYPE_BOOL, ARG_NOMINMAX, nullptr
     },
+    {
+      "routes", &routesopt, "Also filter route points",
+      nullptr, ARGTYPE_BOOL, ARG_NOMINMAX, nullptr
+    },
+    {
+      "tracks", &tracksopt, "Also filter track points",
+      nullptr, ARGTYPE_BOOL, ARG_NOMINMAX, nullptr
+    },
   };
 
 };
@@ -130,6 +130,30 @@ track_add_wpt(route_head* rte, Waypoint* wpt, QStringView namepart, int number_d
   global_track_list->add_wpt(rte, wpt, false, namepart, number_digits);
 }
 
+/*
+ * Append a batch of waypoints to a route or track, equivalent to
+ * adding them one at a time but sizing the waypoint list just once.
+ */
+void
+route_add_wpts(route_head* rte, const QList<Waypoint*>& wpts, QStringView namepart, int number_digits)
+{
+  if (rte->waypoint_list.empty() && !wpts.isEmpty()) {
+    wpts.front()->wpt_flags.new_trkseg = 1;
+  }
+
+  global_route_list->add_wpts(rte, wpts, true, namepart, number_digits);
+}
+
+void
+track_add_wpts(route_head* rte, const QList<Waypoint*>& wpts)
+{
+  if (rte->waypoint_list.empty() && !wpts.isEmpty()) {
+    wpts.front()->wpt_flags.new_trkseg = 1;
+  }
+
+  global_track_list->add_wpts(rte, wpts, false, u"RPT", 3);
+}
+
 void
 route_del_wpt(route_head* rte, Waypoint* wpt)
 {
@@ -235,6 +259,12 @@ route_swap(RouteList& other)
   global_route_list->swap(other);
 }
 
+void
+route_splice(RouteList& src)
+{
+  global_route_list->splice(src);
+}
+
 void
 track_backup(RouteList** head_bak)
 {
@@ -253,16 +283,27 @@ track_swap(RouteList& other)
   global_track_list->swap(other);
 }
 
+void
+track_splice(RouteList& src)
+{
+  global_track_list->splice(src);
+}
+
 /*
  * This really makes more sense for tracks than routes.
  * Run over all the trackpoints, computing heading (course), speed, and
  * and so on.
  *
  * return a collection of (hopefully interesting) statistics about the track.
+ *
+ * The result is not cached.  Readers and filters change trackpoints in
+ * place, so a cached copy can't be kept valid cheaply, and the writers
+ * that need the statistics only ask once per track.
  */
 computed_trkdata track_recompute(const route_head* trk)
 {
   const Waypoint* prev = nullptr;
+  qint64 prev_msecs = 0;
   int tkpt = 0;
   int pts_hrt = 0;
   double tot_hrt = 0.0;
@@ -270,9 +311,14 @@ computed_trkdata track_recompute(const route_head* trk)
   double tot_cad = 0.0;
   int pts_pwr = 0;
   double tot_pwr = 0.0;
+  qint64 start_msecs = 0;
+  qint64 end_msecs = 0;
   computed_trkdata tdata;
 
-  foreach (Waypoint* thisw, trk->waypoint_list) {
+  for (Waypoint* thisw : std::as_const(trk->waypoint_list)) {
+    const gpsbabel::DateTime& thisw_time = thisw->creation_time;
+    const bool thisw_has_time = thisw_time.isValid();
+    const qint64 thisw_msecs = thisw_has_time ? thisw_time.toMSecsSinceEpoch() : 0;
 
     if (prev != nullptr) {
       /*
@@ -293,22 +339,21 @@ computed_trkdata track_recompute(const route_head* trk)
       if (!thisw->speed_has_value() && (dist > 1)) {
         // Only recompute speed if the waypoint
         // didn't already have a speed
-        if (thisw->GetCreationTime().isValid() &&
-            prev->GetCreationTime().isValid() &&
-            thisw->GetCreationTime() > prev->GetCreationTime()) {
-          double timed =
-            prev->GetCreationTime().msecsTo(thisw->GetCreationTime()) / 1000.0;
+        if (thisw_has_time && prev->creation_time.isValid() &&
+            (thisw_msecs > prev_msecs)) {
+          double timed = (thisw_msecs - prev_msecs) / 1000.0;
           thisw->set_speed(dist / timed);
         }
       }
     }
 
     if (thisw->speed_has_value()) {
-      if ((!tdata.min_spd) || (thisw->speed_value() < tdata.min_spd)) {
-        tdata.min_spd = thisw->speed_value();
+      const double speed = thisw->speed_value();
+      if ((!tdata.min_spd) || (speed < tdata.min_spd)) {
+        tdata.min_spd = speed;
       }
-      if ((!tdata.max_spd) || (thisw->speed_value() > tdata.max_spd)) {
-        tdata.max_spd = thisw->speed_value();
+      if ((!tdata.max_spd) || (speed > tdata.max_spd)) {
+        tdata.max_spd = speed;
       }
     }
 
@@ -324,9 +369,6 @@ computed_trkdata track_recompute(const route_head* trk)
     if (thisw->heartrate > 0) {
       pts_hrt++;
       tot_hrt += thisw->heartrate;
-    }
-
-    if (thisw->heartrate > 0) {
       if ((!tdata.min_hrt) || (thisw->heartrate < tdata.min_hrt)) {
         tdata.min_hrt = thisw->heartrate;
       }
@@ -338,36 +380,37 @@ computed_trkdata track_recompute(const route_head* trk)
     if (thisw->cadence > 0) {
       pts_cad++;
       tot_cad += thisw->cadence;
-    }
-
-    if ((thisw->cadence > 0) && ((!tdata.max_cad) || (thisw->cadence > tdata.max_cad))) {
-      tdata.max_cad = thisw->cadence;
+      if ((!tdata.max_cad) || (thisw->cadence > tdata.max_cad)) {
+        tdata.max_cad = thisw->cadence;
+      }
     }
 
     if (thisw->power > 0) {
       pts_pwr++;
       tot_pwr += thisw->power;
+      if ((!tdata.max_pwr) || (thisw->power > tdata.max_pwr)) {
+        tdata.max_pwr = thisw->power;
+      }
     }
 
-    if ((thisw->power > 0) && ((!tdata.max_pwr) || (thisw->power > tdata.max_pwr))) {
-      tdata.max_pwr = thisw->power;
-    }
-
-    if (thisw->GetCreationTime().isValid()) {
-      if (!tdata.start.isValid() || (thisw->GetCreationTime() < tdata.start)) {
-        tdata.start = thisw->GetCreationTime();
+    if (thisw_has_time) {
+      if (!tdata.start.isValid() || (thisw_msecs < start_msecs)) {
+        tdata.start = thisw_time;
+        start_msecs = thisw_msecs;
       }
 
-      if (!tdata.end.isValid() || (thisw->GetCreationTime() > tdata.end)) {
-        tdata.end = thisw->GetCreationTime();
+      if (!tdata.end.isValid() || (thisw_msecs > end_msecs)) {
+        tdata.end = thisw_time;
+        end_msecs = thisw_msecs;
       }
     }
 
     if (thisw->shortname.isEmpty()) {
-      thisw->shortname = QStringLiteral("%1-%2").arg(trk->rte_name).arg(tkpt);
+      thisw->shortname = trk->rte_name + u'-' + QString::number(tkpt);
     }
     tkpt++;
     prev = thisw;
+    prev_msecs = thisw_msecs;
   }
 
   if (pts_hrt > 0) {
@@ -443,6 +486,13 @@ RouteList::add_wpt(route_head* rte, Waypoint* wpt, bool synth, QStringView namep
   rte->waypoint_list.add_rte_waypt(waypt_ct, wpt, synth, namepart, number_digits);
 }
 
+void
+RouteList::add_wpts(route_head* rte, const QList<Waypoint*>& wpts, bool synth, QStringView namepart, int number_digits)
+{
+  rte->waypoint_list.add_rte_waypts(waypt_ct, wpts, synth, namepart, number_digits);
+  waypt_ct += wpts.size();
+}
+
 void
 RouteList::del_wpt(route_head* rte, Waypoint* wpt)
 {
@@ -546,6 +596,23 @@ void RouteList::swap(RouteList& other)
   other = tmp_list;
 }
 
+/*
+ * Like copy() followed by src.flush(), but the route heads and their
+ * waypoints change owner instead of being duplicated and then deleted.
+ */
+void RouteList::splice(RouteList& src)
+{
+  if (&src == this) {
+    return;
+  }
+  for (route_head* rte : std::as_const(src)) {
+    add_head(rte);
+    waypt_ct += rte->rte_waypt_ct();
+  }
+  src.clear();
+  src.waypt_ct = 0;
+}
+
 void RouteList::swap_wpts(route_head* rte, WaypointList& other)
 {
   this->waypt_ct -= rte->rte_waypt_ct();
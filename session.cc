@@ -48,7 +48,8 @@ const session_t*
 curr_session()
 {
   if (!session_list.isEmpty()) {
-    return &session_list.last();
+    // Waypoints may be created by filter worker threads, don't detach.
+    return &session_list.constLast();
   } else {
     gbFatal("Attempt to fetch session outside of session range.\n");
   }
@@ -23,25 +23,28 @@
     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 
-#include <algorithm>       // for max, min
+#include <algorithm>       // for all_of, max, min
 #include <cctype>          // for isprint
 #include <cmath>           // for cos, sin, atan2, pow, sqrt
 #include <cstdarg>         // for va_end, va_list, va_start
 #include <cstdio>          // for sscanf, snprintf, vprintf, SEEK_SET
 #include <cstdlib>         // for free
-#include <cstring>         // for memset
+#include <cstring>         // for memcmp, memcpy, memset
+#include <memory>          // for make_unique, unique_ptr
 #include <numbers>         // for inv_pi, pi
 
 #include <QByteArray>      // for QByteArray
 #include <QChar>           // for QChar
+#include <QFile>           // for QFile
+#include <QIODevice>       // for QIODevice
 #include <QLatin1Char>     // for QLatin1Char
 #include <QThread>         // for QThread
 #include <QtGlobal>        // for qPrintable
 
 #include "defs.h"
 #include "skytraq.h"
-#include "gbfile.h"        // for gbfclose, gbfopen, gbfread, gbfseek, gbfwrite
-#include "gbser.h"         // for gbser_set_speed, gbser_OK, gbser_deinit
+#include "gbfile.h"        // for gbfclose, gbfopen, gbfread, gbfseek, gbfwrite, gbfflush, gbfoff_t
+#include "gbser.h"         // for gbser_set_speed, gbser_OK, gbser_deinit, gbser_write
 
 
 #define TIMEOUT			5000
@@ -183,8 +186,13 @@ SkytraqBase::wr_char(int c)
 void
 SkytraqBase::wr_buf(const unsigned char* str, int len)
 {
+  int rc;
   for (int i = 0; i < len; i++) {
-    wr_char(str[i]);
+    dbg(4, "Sending: %02x '%c'\n", (unsigned)str[i], isprint(str[i]) ? str[i] : '.');
+  }
+  /* One write for the whole message, not one per byte. */
+  if (rc = gbser_write(serial_handle, str, len), gbser_OK != rc) {
+    gbFatal("Write error (%d)\n", rc);
   }
 }
 
@@ -943,7 +951,15 @@ SkytraqBase::skytraq_read_tracks()
   int opt_first_sector_val = opt_first_sector.get_result();
   int opt_last_sector_val = opt_last_sector.get_result();
   int multi_read_supported = 1;
+  int read_errors = 0;		/* failed multi sector reads so far */
+  int good_reads = 0;		/* successful multi sector reads since the last failure */
   gbfile* dumpfile = nullptr;
+  QByteArray cache;		/* sectors kept from the previous download */
+  int cache_end = 0;		/* sectors [1, cache_end) are taken from the cache */
+  int cached_sectors = 0;
+  std::unique_ptr<QFile> cachefile;
+  int cache_valid = 0;		/* sectors of the cache file that match the device */
+  bool cache_complete = false;
 
   state_init(&st);
 
@@ -989,48 +1005,119 @@ SkytraqBase::skytraq_read_tracks()
     dumpfile = gbfopen(opt_dump_file, "w");
   }
 
+  /* The log only grows until it is erased, so all but the last used sector
+   * of the previous download are still valid if sector 0 is unchanged.
+   * Sectors are written over the cache in place as they arrive, so if the
+   * download is interrupted the cache keeps both the new sectors and the
+   * old ones past the failure, and the next download resumes from there.
+   */
+  if (opt_cache) {
+    if (opt_first_sector_val != 0) {
+      dbg(1, "Ignoring cache, it is only used when reading from sector 0\n");
+    } else {
+      cachefile = std::make_unique<QFile>(opt_cache.get());
+      if (!cachefile->open(QIODevice::ReadWrite)) {
+        gbFatal("Can't open cache file '%s'\n", gbLogCStr(opt_cache));
+      }
+      cache = cachefile->readAll();
+      cache.truncate(cache.size() - cache.size() % SECTOR_SIZE);
+    }
+  }
+
   dbg(1, "Reading log data from device...\n");
   dbg(1, "start=%d used=%d\n", opt_first_sector_val, sectors_used);
   dbg(1, "opt_last_sector_val=%d\n", opt_last_sector_val);
   for (int i = opt_first_sector_val; i < sectors_used; i += got_sectors) {
-    for (t = 0, got_sectors = 0; (t < SECTOR_RETRIES) && (got_sectors <= 0); t++) {
-      if (opt_read_at_once.get_result() == 0  ||  multi_read_supported == 0) {
-        rc = skytraq_read_single_sector(i, buffer);
-        if (rc == res_OK) {
-          got_sectors = 1;
+    if (i > 0 && i < cache_end) {
+      memcpy(buffer, cache.constData() + i*SECTOR_SIZE, SECTOR_SIZE);
+      got_sectors = 1;
+      cached_sectors++;
+      cache_valid = i + 1;
+    } else {
+      for (t = 0, got_sectors = 0; (t < SECTOR_RETRIES) && (got_sectors <= 0); t++) {
+        if (opt_read_at_once.get_result() == 0  ||  multi_read_supported == 0) {
+          rc = skytraq_read_single_sector(i, buffer);
+          if (rc == res_OK) {
+            got_sectors = 1;
+          }
+        } else {
+          /* Try to read read_at_once sectors at once.
+           * If there aren't so many interesting ones, read the remainder (sectors_used-i).
+           * And read at least 1 sector.  Sector 0 alone decides whether the
+           * cache can be used, so don't read past it then, and don't let
+           * that read tune read_at_once.
+           */
+          const bool cache_probe = (i == 0 && cache.size() > SECTOR_SIZE);
+          int count = std::max(std::min(read_at_once, sectors_used-i), 1);
+          if (cache_probe) {
+            count = 1;
+          }
+
+          rc = skytraq_read_multiple_sectors(i, count, buffer);
+          switch (rc) {
+          case res_OK:
+            got_sectors = count;
+            /* After errors, only grow again once the good reads since the
+             * last failure outnumber all failures so far.
+             */
+            if (!cache_probe && ++good_reads > read_errors) {
+              read_at_once = std::min(count*2, opt_read_at_once.get_result());
+            }
+            break;
+
+          case res_NACK:
+            dbg(1, "Device doesn't seem to support reading multiple "
+               "sectors at once, falling back to single read.\n");
+            multi_read_supported = 0;
+            break;
+
+          default:
+            /* On failure, try with less sectors */
+            read_errors++;
+            good_reads = 0;
+            if (!cache_probe) {
+              read_at_once = std::max(count/2, 1);
+            }
+          }
         }
-      } else {
-        /* Try to read read_at_once sectors at once.
-         * If there aren't so many interesting ones, read the remainder (sectors_used-i).
-         * And read at least 1 sector.
-         */
-        read_at_once = std::max(std::min(read_at_once, sectors_used-i), 1);
-
-        rc = skytraq_read_multiple_sectors(i, read_at_once, buffer);
-        switch (rc) {
-        case res_OK:
-          got_sectors = read_at_once;
-          read_at_once = std::min(read_at_once*2, opt_read_at_once.get_result());
-          break;
-
-        case res_NACK:
-          dbg(1, "Device doesn't seem to support reading multiple "
-             "sectors at once, falling back to single read.\n");
-          multi_read_supported = 0;
-          break;
-
-        default:
-          /* On failure, try with less sectors */
-          read_at_once = std::max(read_at_once/2, 1);
+      }
+      if (got_sectors <= 0) {
+        gbFatal("Error reading sector %i\n", i);
+      }
+
+      if (i == 0 && cachefile) {
+        if (cache.size() > SECTOR_SIZE &&
+            memcmp(buffer, cache.constData(), SECTOR_SIZE) == 0) {
+          cache_end = cache.size() / SECTOR_SIZE - 1;
+        } else {
+          if (!cache.isEmpty()) {
+            dbg(1, "Cache holds data of another device or log, ignoring it\n");
+          }
+          /* None of the old sectors may survive into the new cache. */
+          cachefile->resize(0);
         }
       }
     }
-    if (got_sectors <= 0) {
-      gbFatal("Error reading sector %i\n", i);
-    }
 
     total_sectors_read += got_sectors;
 
+    if (cachefile && !cache_complete && !(i > 0 && i < cache_end)) {
+      for (int s = 0; s < got_sectors && !cache_complete; s++) {
+        const uint8_t* sector = buffer + s*SECTOR_SIZE;
+        if (std::all_of(sector, sector + SECTOR_SIZE, [](uint8_t b) { return b == 0xFF; })) {
+          cache_complete = true;
+        } else if (!cachefile->seek(static_cast<qint64>(i+s) * SECTOR_SIZE) ||
+                   cachefile->write(reinterpret_cast<const char*>(sector), SECTOR_SIZE) != SECTOR_SIZE) {
+          gbFatal("Can't write cache file '%s'\n", gbLogCStr(opt_cache));
+        } else {
+          cache_valid = i + s + 1;
+        }
+      }
+      if (!cachefile->flush()) {
+        gbFatal("Can't write cache file '%s'\n", gbLogCStr(opt_cache));
+      }
+    }
+
     if (dumpfile) {
       gbfwrite(buffer, SECTOR_SIZE, got_sectors, dumpfile);
     }
@@ -1055,11 +1142,18 @@ SkytraqBase::skytraq_read_tracks()
     }
   }
   free(buffer);
-  dbg(1, "Got %i trackpoints from %i sectors.\n", st.tpn, total_sectors_read);
+  dbg(1, "Got %i trackpoints from %i sectors, %i of them cached.\n", st.tpn, total_sectors_read, cached_sectors);
 
   if (dumpfile) {
     gbfclose(dumpfile);
   }
+  if (cachefile) {
+    /* Drop whatever followed the end of the log. */
+    if (!cachefile->resize(static_cast<qint64>(cache_valid) * SECTOR_SIZE)) {
+      gbFatal("Can't write cache file '%s'\n", gbLogCStr(opt_cache));
+    }
+    cachefile->close();
+  }
 }
 
 int
@@ -1261,8 +1355,9 @@ SkytraqfileFormat::read()
   auto* buffer = (uint8_t*) xmalloc(SECTOR_SIZE);
 
   if (opt_first_sector_val > 0) {
-    dbg(4, "Seeking to first-sector index %i\n", opt_first_sector_val*SECTOR_SIZE);
-    gbfseek(file_handle, opt_first_sector_val*SECTOR_SIZE, SEEK_SET);
+    gbfoff_t offset = static_cast<gbfoff_t>(opt_first_sector_val) * SECTOR_SIZE;
+    dbg(4, "Seeking to first-sector index %lld\n", static_cast<long long>(offset));
+    gbfseek(file_handle, offset, SEEK_SET);
   }
 
   dbg(1, "Reading log data from file...\n");
@@ -158,6 +158,7 @@ protected:
   OptionInt opt_first_sector;	/* first sector to be read from the device (default: 0) */
   OptionInt opt_last_sector;	/* last sector to be read from the device (default: smart read everything) */
   OptionString opt_dump_file;		/* dump raw data to this file (optional) */
+  OptionString opt_cache;		/* keep downloaded sectors in this file (optional) */
   OptionBool    opt_no_output;		/* disable output? (0/1) */
   OptionString opt_set_location;	/* set if the "targetlocation" options was used */
   OptionString opt_configure_logging;
@@ -228,6 +229,10 @@ private:
       "dump-file", &opt_dump_file, "Dump raw data to this file",
       nullptr, ARGTYPE_OUTFILE, ARG_NOMINMAX, nullptr
     },
+    {
+      "cache", &opt_cache, "Cache downloaded sectors in this file",
+      nullptr, ARGTYPE_STRING, ARG_NOMINMAX, nullptr
+    },
     {
       "no-output", &opt_no_output, "Disable output (useful with erase)",
       "0", ARGTYPE_BOOL, ARG_NOMINMAX, nullptr
@@ -275,7 +280,7 @@ private:
   QVector<arglist_t> skytraq_fargs = {
     {
       "first-sector", &opt_first_sector, "First sector to be read from the file",
-      "0", ARGTYPE_INT, "0", "65535", nullptr
+      "0", ARGTYPE_INT, "0", nullptr, nullptr
     },
     {
       "last-sector", &opt_last_sector, "Last sector to be read from the file (-1: read till empty sector)",
@@ -349,6 +354,7 @@ private:
 
   QVector<arglist_t> miniHomer_args = {
     { "baud",         &opt_dlbaud,        "Baud rate used for download", "115200", ARGTYPE_INT, "0", "115200", nullptr },
+    { "cache",        &opt_cache,         "Cache downloaded sectors in this file", nullptr, ARGTYPE_STRING, ARG_NOMINMAX, nullptr },
     { "dump-file",    &opt_dump_file,     "Dump raw data to this file", nullptr, ARGTYPE_OUTFILE, ARG_NOMINMAX, nullptr },
     { "erase",        &opt_erase,         "Erase device data after download", "0", ARGTYPE_BOOL, ARG_NOMINMAX, nullptr },
     { "first-sector", &opt_first_sector,  "First sector to be read from the device", "0", ARGTYPE_INT, "0", "65535", nullptr },
@@ -56,12 +56,13 @@
 	2008/08/20: added "relative" option, (Carsten Allefeld, carsten.allefeld@googlemail.com)
 */
 
+#include <algorithm>            // for min
 #include <cassert>
-#include <iterator>             // for prev
+#include <utility>              // for move, pair
+#include <vector>               // for vector
 
-#include <QDateTime>            // for QDateTime
-#include <QHash>                // for QHash
-#include <QMap>                 // for QMap
+#include <QStringLiteral>       // for QStringLiteral
+#include <QtGlobal>             // for qsizetype
 
 #include "defs.h"
 #include "smplrout.h"
@@ -71,172 +72,215 @@
 
 #if FILTERS_ENABLED
 
-inline bool operator<(const SimplifyRouteFilter::trackerror& lhs, const SimplifyRouteFilter::trackerror& rhs)
+SimplifyRouteFilter::ErrorHeap::ErrorHeap(std::vector<double> initial_errors) :
+  errors(std::move(initial_errors))
 {
-  return ((lhs.dist > rhs.dist) || ((lhs.dist == rhs.dist) && (lhs.wptpos < rhs.wptpos)));
+  const qsizetype n = errors.size();
+  heap.resize(n);
+  heap_pos.resize(n);
+  for (qsizetype idx = 0; idx < n; ++idx) {
+    place(idx, idx);
+  }
+  for (qsizetype hpos = n / 2 - 1; hpos >= 0; --hpos) {
+    sift_down(hpos);
+  }
+}
+
+void SimplifyRouteFilter::ErrorHeap::pop()
+{
+  heap_pos[heap.front()] = -1;
+  const qsizetype last = heap.back();
+  heap.pop_back();
+  if (!heap.empty()) {
+    place(0, last);
+    sift_down(0);
+  }
+}
+
+void SimplifyRouteFilter::ErrorHeap::update(qsizetype idx, double error)
+{
+  const qsizetype hpos = heap_pos[idx];
+  assert(hpos >= 0);
+  errors[idx] = error;
+  sift_up(hpos);
+  sift_down(heap_pos[idx]);
+}
+
+void SimplifyRouteFilter::ErrorHeap::sift_up(qsizetype hpos)
+{
+  const qsizetype idx = heap[hpos];
+  while (hpos > 0) {
+    const qsizetype parent = (hpos - 1) / 2;
+    if (!before(idx, heap[parent])) {
+      break;
+    }
+    place(hpos, heap[parent]);
+    hpos = parent;
+  }
+  place(hpos, idx);
 }
 
-double SimplifyRouteFilter::compute_track_error(const neighborhood& nb) const
+void SimplifyRouteFilter::ErrorHeap::sift_down(qsizetype hpos)
 {
+  const qsizetype n = heap.size();
+  const qsizetype idx = heap[hpos];
+  while (true) {
+    qsizetype child = 2 * hpos + 1;
+    if (child >= n) {
+      break;
+    }
+    if ((child + 1 < n) && before(heap[child + 1], heap[child])) {
+      ++child;
+    }
+    if (!before(heap[child], idx)) {
+      break;
+    }
+    place(hpos, heap[child]);
+    hpos = child;
+  }
+  place(hpos, idx);
+}
+
+double SimplifyRouteFilter::compute_track_error(const std::vector<SimplifyPoint>& pts, qsizetype idx) const
+{
+  const SimplifyPoint& pt3 = pts[idx];
+
   /* if no previous, this is an endpoint and must be preserved. */
-  if (nb.prev == nullptr) {
+  if (pt3.prev < 0) {
     return kHugeValue;
   }
-  const Waypoint* wpt1 = nb.prev;
+  const SimplifyPoint& pt1 = pts[pt3.prev];
 
   /* if no next, this is an endpoint and must be preserved. */
-  if (nb.next == nullptr) {
+  if (pt3.next < 0) {
     return kHugeValue;
   }
-  const Waypoint* wpt2 = nb.next;
+  const SimplifyPoint& pt2 = pts[pt3.next];
 
-  const Waypoint* wpt3 = nb.wpt;
   double track_error;
   switch (metric) {
   case metric_t::crosstrack:
-    track_error = radtometers(linedist(
-                               wpt1->position(),
-                               wpt2->position(),
-                               wpt3->position()));
+    track_error = radtometers(linedist(pt1.pos, pt2.pos, pt3.pos));
     break;
   case metric_t::length:
     track_error = radtometers(
-                    gcdist(wpt1->position(), wpt3->position()) +
-                    gcdist(wpt3->position(), wpt2->position()) -
-                    gcdist(wpt1->position(), wpt2->position()));
+                    gcdist(pt1.pos, pt3.pos) +
+                    gcdist(pt3.pos, pt2.pos) -
+                    gcdist(pt1.pos, pt2.pos));
     break;
   case metric_t::relative:
   default: // eliminate false positive warning with g++ 11.3.0: ‘error’ may be used uninitialized in this function [-Wmaybe-uninitialized]
     // if timestamps exist, distance to interpolated point
-    if (wpt1->GetCreationTime().isValid() &&
-        wpt2->GetCreationTime().isValid() &&
-        wpt3->GetCreationTime().isValid() &&
-        (wpt1->GetCreationTime() != wpt2->GetCreationTime())) {
-      double frac = static_cast<double>(wpt1->GetCreationTime().msecsTo(wpt3->GetCreationTime())) /
-                    static_cast<double>(wpt1->GetCreationTime().msecsTo(wpt2->GetCreationTime()));
-      auto respos = linepart(wpt1->position(),
-                             wpt2->position(),
-                             frac);
-      track_error = radtometers(gcdist(wpt3->position(), respos));
+    if (pt1.has_time && pt2.has_time && pt3.has_time &&
+        (pt1.msecs != pt2.msecs)) {
+      double frac = static_cast<double>(pt3.msecs - pt1.msecs) /
+                    static_cast<double>(pt2.msecs - pt1.msecs);
+      auto respos = linepart(pt1.pos, pt2.pos, frac);
+      track_error = radtometers(gcdist(pt3.pos, respos));
     } else { // else distance to connecting line
-      track_error = radtometers(linedist(
-                                  wpt1->position(),
-                                  wpt2->position(),
-                                  wpt3->position()));
+      track_error = radtometers(linedist(pt1.pos, pt2.pos, pt3.pos));
     }
     // error relative to horizontal precision
-    track_error /= (6 * wpt3->hdop);
+    track_error /= (6 * pt3.hdop);
     // (hdop->meters following to J. Person at <http://www.developerfusion.co.uk/show/4652/3/>)
     break;
   }
   return track_error;
 }
 
-void SimplifyRouteFilter::routesimple_head(const route_head* rte)
+/*
+ * Mark the points of rte to be removed.  This runs on a worker thread,
+ * see Filter::parallel_map_routes.
+ */
+void SimplifyRouteFilter::routesimple_head(const route_head* rte, RouteResult& result) const
 {
+  const qsizetype npts = rte->rte_waypt_ct();
+
   /* short-circuit if we already have fewer than the max points */
-  if ((limit_basis == limit_basis_t::count) && count >= rte->rte_waypt_ct()) {
+  if ((limit_basis == limit_basis_t::count) && count >= npts) {
     return;
   }
 
   /* short-circuit if the route is impossible to simplify, too. */
-  if (2 >= rte->rte_waypt_ct()) {
+  if (2 >= npts) {
+    return;
+  }
+
+  if (window > 0) {
+    routesimple_windowed(rte);
     return;
   }
 
-  /* compute all distances */
-  /* sort XTE array, lowest XTE last */
-  Waypoint* pwpt = nullptr;
-  Waypoint* ppwpt = nullptr;
-  WaypointList::size_type pos = 0;
-  neighborhood nb;
-  trackerror te;
-  QMap<trackerror, neighborhood> errormap;
-  QHash<Waypoint*, trackerror> wpthash;
+  /* gather the data the metrics need into a doubly linked array */
+  std::vector<Waypoint*> wpts;
+  std::vector<SimplifyPoint> pts;
+  wpts.reserve(npts);
+  pts.reserve(npts);
   for (auto* wpt : rte->waypoint_list) {
     wpt->extra_data = nullptr;
 
     if (metric == metric_t::relative) {
       // check hdop is available for compute_track_error
       if (wpt->hdop == 0) {
-        gbFatal("relative needs hdop information.\n");
+        result.error = QStringLiteral("relative needs hdop information.");
+        return;
       }
     }
 
-    if (pwpt != nullptr) {
-      nb.wpt = pwpt;
-      nb.prev = ppwpt;
-      nb.next = wpt;
-
-      te.dist = compute_track_error(nb);
-      te.wptpos = pos;
-
-      errormap.insert(te, nb);
-      wpthash.insert(pwpt, te);
+    SimplifyPoint pt;
+    pt.pos = wpt->position();
+    pt.has_time = wpt->creation_time.isValid();
+    if (pt.has_time) {
+      pt.msecs = wpt->creation_time.toMSecsSinceEpoch();
     }
-
-    ppwpt = pwpt;
-    pwpt = wpt;
-    ++pos;
+    pt.hdop = wpt->hdop;
+    pt.prev = static_cast<qsizetype>(pts.size()) - 1;
+    pt.next = static_cast<qsizetype>(pts.size()) + 1;
+    wpts.push_back(wpt);
+    pts.push_back(pt);
   }
-  nb.wpt = pwpt;
-  nb.prev = ppwpt;
-  nb.next = nullptr;
+  pts.back().next = -1;
 
-  te.dist = compute_track_error(nb);
-  te.wptpos = pos;
-
-  errormap.insert(te, nb);
-  wpthash.insert(pwpt, te);
+  /* compute all errors */
+  std::vector<double> errors(npts);
+  for (qsizetype idx = 0; idx < npts; ++idx) {
+    errors[idx] = compute_track_error(pts, idx);
+  }
+  ErrorHeap heap(std::move(errors));
 
-  assert(!errormap.isEmpty());
-  double totalerror = errormap.lastKey().dist;
+  double totalerror = heap.top_error();
 
   /* while we still have too many records... */
-  while ((!errormap.isEmpty()) &&
-         (((limit_basis == limit_basis_t::count) && (count < errormap.size())) ||
+  while ((!heap.empty()) &&
+         (((limit_basis == limit_basis_t::count) && (count < heap.size())) ||
           ((limit_basis == limit_basis_t::error) && (totalerror < error)))) {
 
     /* remove the record with the lowest XTE */
-    neighborhood goner = errormap.last();
-    goner.wpt->wpt_flags.marked_for_deletion = 1;
-    // errormap.remove(lastKey());  // with Qt 5.12.12, 5.15.2 results in asan heap-use-after-free errors in build_extra_tests.sh
-    errormap.erase(std::prev(errormap.cend())); // in Qt6 can use cend().
-    // wpthash.remove(goner.wpt); // removal not necessary
+    const qsizetype goner = heap.top();
+    heap.pop();
+    wpts[goner]->wpt_flags.marked_for_deletion = 1;
 
     /* recompute neighbors of point marked for deletion. */
-    if (goner.prev != nullptr) {
-      assert(wpthash.contains(goner.prev));
-      trackerror terr = wpthash.value(goner.prev);
-      assert(errormap.contains(terr));
-      neighborhood nbh = errormap.value(terr);
-      nbh.next = goner.next;
-      errormap.remove(terr);
-      terr.dist = compute_track_error(nbh);
-      errormap.insert(terr, nbh);
-      wpthash.insert(goner.prev, terr);
+    const qsizetype prev = pts[goner].prev;
+    const qsizetype next = pts[goner].next;
+    if (prev >= 0) {
+      pts[prev].next = next;
+      heap.update(prev, compute_track_error(pts, prev));
     }
-    if (goner.next != nullptr) {
-      assert(wpthash.contains(goner.next));
-      trackerror terr = wpthash.value(goner.next);
-      assert(errormap.contains(terr));
-      neighborhood nbh = errormap.value(terr);
-      nbh.prev = goner.prev;
-      errormap.remove(terr);
-      terr.dist = compute_track_error(nbh);
-      errormap.insert(terr, nbh);
-      wpthash.insert(goner.next, terr);
+    if (next >= 0) {
+      pts[next].prev = prev;
+      heap.update(next, compute_track_error(pts, next));
     }
 
     /* compute impact of deleting next point */
-    if (limit_basis == limit_basis_t::error) {
+    if ((limit_basis == limit_basis_t::error) && !heap.empty()) {
       switch (metric) {
       case metric_t::crosstrack:
       case metric_t::relative:
-        totalerror = errormap.lastKey().dist;
+        totalerror = heap.top_error();
         break;
       case metric_t::length:
-        totalerror += errormap.lastKey().dist;
+        totalerror += heap.top_error();
         break;
       }
     }
@@ -244,21 +288,104 @@ void SimplifyRouteFilter::routesimple_head(const route_head* rte)
   } /* end of too many records loop */
 }
 
+/*
+ * Douglas-Peucker simplification of rte, one window of at most window
+ * points at a time, so the working storage stays bounded however long
+ * the track is.  Only the part of a window up to its last interior
+ * vertex is final, the rest is redone as the start of the next window,
+ * so window boundaries rarely force extra vertices.  Every removed point
+ * is within error (crosstrack) of the line between the vertices kept
+ * around it.
+ */
+void SimplifyRouteFilter::routesimple_windowed(const route_head* rte) const
+{
+  const WaypointList& wpts = rte->waypoint_list;
+  const qsizetype npts = wpts.count();
+  std::vector<PositionRad> pos;
+  std::vector<unsigned char> keep;
+  std::vector<std::pair<qsizetype, qsizetype>> spans;
+  pos.reserve(window);
+  keep.reserve(window);
+
+  qsizetype start = 0;
+  while (start < npts - 1) {
+    const qsizetype end = std::min<qsizetype>(start + window - 1, npts - 1);
+    const qsizetype len = end - start + 1;
+    pos.clear();
+    for (auto it = wpts.cbegin() + start; it != wpts.cbegin() + end + 1; ++it) {
+      pos.push_back((*it)->position());
+    }
+
+    keep.assign(len, 0);
+    keep.front() = 1;
+    keep.back() = 1;
+    spans.assign(1, {0, len - 1});
+    while (!spans.empty()) {
+      const auto [first, last] = spans.back();
+      spans.pop_back();
+      double dmax = -1.0;
+      qsizetype imax = -1;
+      for (qsizetype i = first + 1; i < last; ++i) {
+        double dist = radtometers(linedist(pos[first], pos[last], pos[i]));
+        if (dist > dmax) {
+          dmax = dist;
+          imax = i;
+        }
+      }
+      if ((imax >= 0) && !(dmax < error)) {
+        keep[imax] = 1;
+        spans.emplace_back(first, imax);
+        spans.emplace_back(imax, last);
+      }
+    }
+
+    qsizetype done = len - 1;
+    if (end < npts - 1) {
+      qsizetype vertex = len - 2;
+      while ((vertex > 0) && !keep[vertex]) {
+        --vertex;
+      }
+      if (vertex > 0) {
+        done = vertex;
+      }
+    }
+    for (qsizetype i = 1; i < done; ++i) {
+      if (!keep[i]) {
+        (*(wpts.cbegin() + start + i))->wpt_flags.marked_for_deletion = 1;
+      }
+    }
+    start += done;
+  }
+}
+
+/*
+ * Routes are simplified independently of each other, so do that in
+ * parallel, then delete the marked points in route order.
+ */
+void SimplifyRouteFilter::simplify_routes(const RouteList& routes, bool is_track) const
+{
+  const std::vector<RouteResult> results = parallel_map_routes(routes, [this](const route_head* rte, RouteResult& result)->void {
+    routesimple_head(rte, result);
+  });
+
+  auto result = results.cbegin();
+  for (route_head* rte : routes) {
+    if (!result->error.isEmpty()) {
+      gbFatal("%s\n", gbLogCStr(result->error));
+    }
+    if (is_track) {
+      track_del_marked_wpts(rte);
+    } else {
+      route_del_marked_wpts(rte);
+    }
+    ++result;
+  }
+}
+
 void SimplifyRouteFilter::process()
 {
-  auto common_head_lambda = [this](const route_head* rte)->void {
-    routesimple_head(rte);
-  };
-
-  auto route_tail_lambda = [](const route_head* rte)->void {
-    route_del_marked_wpts(const_cast<route_head*>(rte));
-  };
-  route_disp_all(common_head_lambda, route_tail_lambda, nullptr);
-
-  auto track_tail_lambda = [](const route_head* rte)->void {
-    track_del_marked_wpts(const_cast<route_head*>(rte));
-  };
-  track_disp_all(common_head_lambda, track_tail_lambda, nullptr);
+  simplify_routes(*global_route_list, false);
+  simplify_routes(*global_track_list, true);
 }
 
 void SimplifyRouteFilter::init()
@@ -283,6 +410,14 @@ void SimplifyRouteFilter::init()
     gbFatal("You may specify only one of crosstrack, length, or relative.\n");
   }
 
+  window = 0;
+  if (windowopt) {
+    if ((limit_basis != limit_basis_t::error) || (metric != metric_t::crosstrack)) {
+      gbFatal("The window option requires the error option and the crosstrack method.\n");
+    }
+    window = windowopt.get_result();
+  }
+
   switch (limit_basis) {
   case limit_basis_t::count:
     count = countopt.get_result();
@@ -59,9 +59,12 @@
 #ifndef SMPLROUT_H_INCLUDED_
 #define SMPLROUT_H_INCLUDED_
 
+#include <vector>    // for vector
+
 #include <QList>     // for QList
 #include <QString>               // for QString
 #include <QVector>               // for QVector
+#include <QtGlobal>  // for qint64, qsizetype
 
 #include "defs.h"
 #include "filter.h"  // for Filter
@@ -74,13 +77,6 @@ class SimplifyRouteFilter:public Filter
 {
 public:
 
-  /* Types */
-
-  struct trackerror {
-    double dist;
-    WaypointList::size_type wptpos;
-  };
-
   /* Member Functions */
 
   QVector<arglist_t>* get_args() override
@@ -97,10 +93,63 @@ private:
   enum class limit_basis_t {count, error};
   enum class metric_t {crosstrack, length, relative};
 
-  struct neighborhood {
-    Waypoint* wpt;
-    Waypoint* prev;
-    Waypoint* next;
+  /* A point of the route being simplified, linked to its surviving neighbors. */
+  struct SimplifyPoint {
+    PositionRad pos;
+    qint64 msecs{0};	/* creation time, if has_time */
+    bool has_time{false};
+    double hdop{0};
+    qsizetype prev{-1};	/* index of the previous surviving point, or -1 */
+    qsizetype next{-1};	/* index of the next surviving point, or -1 */
+  };
+
+  /*
+   * Binary min-heap of point indices keyed by track error, the top is
+   * the next point to remove.  Ties go to the later point, matching the
+   * order the original QMap based implementation removed points in.
+   * heap_pos tracks where each point sits so its error can be updated
+   * in place when a neighbor is removed.
+   */
+  class ErrorHeap
+  {
+  public:
+    explicit ErrorHeap(std::vector<double> initial_errors);
+
+    bool empty() const
+    {
+      return heap.empty();
+    }
+    qsizetype size() const
+    {
+      return heap.size();
+    }
+    qsizetype top() const
+    {
+      return heap.front();
+    }
+    double top_error() const
+    {
+      return errors[heap.front()];
+    }
+    void pop();
+    void update(qsizetype idx, double error);
+
+  private:
+    bool before(qsizetype a, qsizetype b) const
+    {
+      return (errors[a] < errors[b]) || ((errors[a] == errors[b]) && (a > b));
+    }
+    void place(qsizetype hpos, qsizetype idx)
+    {
+      heap[hpos] = idx;
+      heap_pos[idx] = hpos;
+    }
+    void sift_up(qsizetype hpos);
+    void sift_down(qsizetype hpos);
+
+    std::vector<double> errors;
+    std::vector<qsizetype> heap;
+    std::vector<qsizetype> heap_pos;
   };
 
   /* Constants */
@@ -109,13 +158,16 @@ private:
 
   /* Member Functions */
 
-  double compute_track_error(const neighborhood& nb) const;
-  void routesimple_head(const route_head* rte);
+  double compute_track_error(const std::vector<SimplifyPoint>& pts, qsizetype idx) const;
+  void routesimple_head(const route_head* rte, RouteResult& result) const;
+  void routesimple_windowed(const route_head* rte) const;
+  void simplify_routes(const RouteList& routes, bool is_track) const;
 
   /* Data Members */
 
   int count = 0;
   double error = 0;
+  int window = 0;
   limit_basis_t limit_basis{limit_basis_t::error};
   metric_t metric{metric_t::crosstrack};
 
@@ -124,6 +176,7 @@ private:
   OptionBool xteopt;
   OptionBool lenopt;
   OptionBool relopt;
+  OptionInt windowopt;
 
   QVector<arglist_t> args = {
     {
@@ -146,6 +199,10 @@ private:
       "relative", &relopt, "Use relative error", nullptr,
       ARGTYPE_BOOL | ARGTYPE_END_EXCL, ARG_NOMINMAX, nullptr
     },
+    {
+      "window", &windowopt, "Simplify in windows of this many points",
+      nullptr, ARGTYPE_INT, "3", nullptr, nullptr
+    },
   };
 
 };
@@ -21,49 +21,56 @@
 
 #include "sort.h"
 
+#include <limits>               // for numeric_limits
+
 #include <QDateTime>            // for QDateTime
-#include <QString>              // for operator<, QString
+#include <QString>              // for QString
+#include <QStringView>          // for QStringView
+#include <QtGlobal>             // for qint64
 
 #include "defs.h"
 #include "geocache.h"           // for Geocache
 #include "src/core/datetime.h"  // for DateTime
+#include "src/core/keysort.h"   // for stable_sort_by_key
 
 
 #if FILTERS_ENABLED
 
-bool SortFilter::sort_comp_wpt_by_description(const Waypoint* a, const Waypoint* b)
+QStringView SortFilter::sort_key_wpt_by_description(const Waypoint* wpt)
 {
-  return a->description < b->description;
+  return wpt->description;
 }
 
-bool SortFilter::sort_comp_wpt_by_gcid(const Waypoint* a, const Waypoint* b)
+long long SortFilter::sort_key_wpt_by_gcid(const Waypoint* wpt)
 {
-  return a->gc_data->id < b->gc_data->id;
+  return wpt->gc_data->id;
 }
 
-bool SortFilter::sort_comp_wpt_by_shortname(const Waypoint* a, const Waypoint* b)
+QStringView SortFilter::sort_key_wpt_by_shortname(const Waypoint* wpt)
 {
-  return a->shortname < b->shortname;
+  return wpt->shortname;
 }
 
-bool SortFilter::sort_comp_wpt_by_time(const Waypoint* a, const Waypoint* b)
+qint64 SortFilter::sort_key_wpt_by_time(const Waypoint* wpt)
 {
-  return a->GetCreationTime() < b->GetCreationTime();
+  // Invalid times order before all valid times, as they do for QDateTime.
+  const gpsbabel::DateTime t = wpt->GetCreationTime();
+  return t.isValid() ? t.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
 }
 
-bool SortFilter::sort_comp_rh_by_description(const route_head* a, const route_head* b)
+QStringView SortFilter::sort_key_rh_by_description(const route_head* rte)
 {
-  return a->rte_desc < b->rte_desc;
+  return rte->rte_desc;
 }
 
-bool SortFilter::sort_comp_rh_by_name(const route_head* a, const route_head* b)
+QStringView SortFilter::sort_key_rh_by_name(const route_head* rte)
 {
-  return a->rte_name < b->rte_name;
+  return rte->rte_name;
 }
 
-bool SortFilter::sort_comp_rh_by_number(const route_head* a, const route_head* b)
+int SortFilter::sort_key_rh_by_number(const route_head* rte)
 {
-  return a->rte_num < b->rte_num;
+  return rte->rte_num;
 }
 
 void SortFilter::process()
@@ -72,16 +79,16 @@ void SortFilter::process()
   case SortModeWpt::none:
     break;
   case SortModeWpt::description:
-    waypt_sort(sort_comp_wpt_by_description);
+    waypt_sort_by_key(sort_key_wpt_by_description);
     break;
   case SortModeWpt::gcid:
-    waypt_sort(sort_comp_wpt_by_gcid);
+    waypt_sort_by_key(sort_key_wpt_by_gcid);
     break;
   case SortModeWpt::shortname:
-    waypt_sort(sort_comp_wpt_by_shortname);
+    waypt_sort_by_key(sort_key_wpt_by_shortname);
     break;
   case SortModeWpt::time:
-    waypt_sort(sort_comp_wpt_by_time);
+    waypt_sort_by_key(sort_key_wpt_by_time);
     break;
   default:
     gbFatal("unknown waypoint sort mode.\n");
@@ -91,13 +98,13 @@ void SortFilter::process()
   case SortModeRteHd::none:
     break;
   case SortModeRteHd::description:
-    route_sort(sort_comp_rh_by_description);
+    route_sort_by_key(sort_key_rh_by_description);
     break;
   case SortModeRteHd::name:
-    route_sort(sort_comp_rh_by_name);
+    route_sort_by_key(sort_key_rh_by_name);
     break;
   case SortModeRteHd::number:
-    route_sort(sort_comp_rh_by_number);
+    route_sort_by_key(sort_key_rh_by_number);
     break;
   default:
     gbFatal("unknown route sort mode.\n");
@@ -107,13 +114,13 @@ void SortFilter::process()
   case SortModeRteHd::none:
     break;
   case SortModeRteHd::description:
-    track_sort(sort_comp_rh_by_description);
+    track_sort_by_key(sort_key_rh_by_description);
     break;
   case SortModeRteHd::name:
-    track_sort(sort_comp_rh_by_name);
+    track_sort_by_key(sort_key_rh_by_name);
     break;
   case SortModeRteHd::number:
-    track_sort(sort_comp_rh_by_number);
+    track_sort_by_key(sort_key_rh_by_number);
     break;
   default:
     gbFatal("unknown track sort mode.\n");
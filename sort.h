@@ -24,7 +24,9 @@
 
 #include <QList>     // for QList
 #include <QString>   // for QString
+#include <QStringView>  // for QStringView
 #include <QVector>   // for QVector
+#include <QtGlobal>  // for qint64
 
 #include "defs.h"    // for arglist_t, ARGTYPE_BOOL, ARG_NOMINMAX, Waypoint
 #include "filter.h"  // for Filter
@@ -67,13 +69,17 @@ private:
 
   /* Member Functions */
 
-  static bool sort_comp_wpt_by_description(const Waypoint* a, const Waypoint* b);
-  static bool sort_comp_wpt_by_gcid(const Waypoint* a, const Waypoint* b);
-  static bool sort_comp_wpt_by_shortname(const Waypoint* a, const Waypoint* b);
-  static bool sort_comp_wpt_by_time(const Waypoint* a, const Waypoint* b);
-  static bool sort_comp_rh_by_description(const route_head* a, const route_head* b);
-  static bool sort_comp_rh_by_name(const route_head* a, const route_head* b);
-  static bool sort_comp_rh_by_number(const route_head* a, const route_head* b);
+  /*
+   * Sort keys are extracted once per element, see stable_sort_by_key.
+   * The string keys are views into the sorted elements.
+   */
+  static QStringView sort_key_wpt_by_description(const Waypoint* wpt);
+  static long long sort_key_wpt_by_gcid(const Waypoint* wpt);
+  static QStringView sort_key_wpt_by_shortname(const Waypoint* wpt);
+  static qint64 sort_key_wpt_by_time(const Waypoint* wpt);
+  static QStringView sort_key_rh_by_description(const route_head* rte);
+  static QStringView sort_key_rh_by_name(const route_head* rte);
+  static int sort_key_rh_by_number(const route_head* rte);
 
   /* Data Members */
 
@@ -84,7 +84,7 @@ qint64 CodecDevice::readData(char* data, qint64 maxlen)
       }
     }
 
-    qint64 bytesread = file_->read(charbuffer_, charbuffer_size_);
+    qint64 bytesread = file_->device()->read(charbuffer_, charbuffer_size_);
     if (bytesread <= 0) { // no more data is available or error.
       if (bytesdelivered > 0) {
         break;
@@ -114,7 +114,7 @@ qint64 CodecDevice::writeData(const char* data, qint64 len)
     if (charbuffer_bytes_free_ == 0) {
       static_assert(charbuffer_size_%sizeof(QChar) == 0);
       QByteArray ba = encoder_->fromUnicode(reinterpret_cast<const QChar*>(charbuffer_), charbuffer_size_/sizeof(QChar));
-      file_->write(ba);
+      file_->device()->write(ba);
       charbuffer_data_ = charbuffer_;
       charbuffer_bytes_free_ = charbuffer_size_;
     }
@@ -128,7 +128,7 @@ void CodecDevice::close()
     qint64 bytes = charbuffer_size_ - charbuffer_bytes_free_;
     assert(bytes%sizeof(QChar) == 0);
     QByteArray ba = encoder_->fromUnicode(reinterpret_cast<const QChar*>(charbuffer_), bytes/sizeof(QChar));
-    file_->write(ba);
+    file_->device()->write(ba);
     charbuffer_data_ = charbuffer_;
     charbuffer_bytes_free_ = charbuffer_size_;
   }
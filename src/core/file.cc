@@ -0,0 +1,94 @@
+/*
+    Copyright (C) 2013 Robert Lipe, gpsbabel.org
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ */
+
+#include <cstdio>              // for stdin, stdout
+#include <memory>              // for make_unique
+
+#include <QFileInfo>           // for QFileInfo
+#include <QStringBuilder>      // for operator%
+#include <Qt>                  // for CaseInsensitive
+
+#include "defs.h"              // for gpsbabel_testmode
+#include "src/core/file.h"
+#include "src/core/logging.h"  // for gbFatal, FatalMsg
+
+
+namespace gpsbabel
+{
+
+File::~File()
+{
+  /* ~QFileDevice can't reach our close(). */
+  if (isOpen()) {
+    close();
+  }
+}
+
+bool File::open(OpenMode mode)
+{
+  bool status;
+
+  if (QFile::fileName() == "-") {
+    if (mode & QIODevice::WriteOnly) {
+      status = QFile::open(stdout, mode);
+    } else {
+      status = QFile::open(stdin, mode);
+    }
+#if !ZLIB_INHIBITED
+  } else if ((QFile::fileName().size() > 3) && QFile::fileName().endsWith(".gz", Qt::CaseInsensitive)) {
+    /* The compressed file itself is binary, text mode applies to the device. */
+    status = QFile::open(mode & ~QIODevice::OpenMode(QIODevice::Text));
+    if (status) {
+      gz_ = std::make_unique<GzipDevice>(this);
+      status = gz_->open(mode);
+    }
+#endif
+  } else {
+    status =  QFile::open(mode);
+  }
+
+  if (!status) {
+    gbFatal(FatalMsg().noquote() << "Cannot open '" %
+      (gpsbabel_testmode() ?
+        QFileInfo(*this).fileName() :
+        QFileInfo(*this).absoluteFilePath()) %
+      "' for " %
+      (mode & QIODevice::WriteOnly ? "write" : "read") %
+      ".  Error was '" %
+      QFile::errorString()  %
+      "'.");
+  }
+  return status;
+}
+
+void File::close()
+{
+#if !ZLIB_INHIBITED
+  if (gz_) {
+    gz_->close();
+    gz_.reset();
+  }
+#endif
+  if (isOpen() && (openMode() & QIODevice::WriteOnly) && !flush()) {
+    gbFatal(FatalMsg().noquote() << "Could not write to" << QFile::fileName() << "(" + QFile::errorString() + ")");
+  }
+  QFile::close();
+}
+
+} // namespace gpsbabel
@@ -21,51 +21,45 @@
 #define SRC_CORE_FILE_INCLUDED_H_
 
 #include <QFile>
-#include <QFileInfo>
-#include <QStringBuilder>
 #include <QIODevice>
-#include <cstdio>
-#include "src/core/logging.h"
-#include "defs.h"
+#include <QString>
+#include <memory>
+#include "src/core/gzipdevice.h"
 
 // Mimic gbfile open services
 
 namespace gpsbabel
 {
 
+/*
+ * Like gbfile, files named *.gz are decompressed when read and
+ * compressed when written.  Read and write through device(), which
+ * is the file itself unless it is compressed.
+ */
 class File : public QFile
 {
 public:
-    explicit File(const QString& s) : QFile(s) {}
+  explicit File(const QString& s) : QFile(s) {}
+  ~File() override;
 
   /* in the tradition of gbfile we assume WriteOnly or ReadOnly, not ReadWrite */
-  bool open(OpenMode mode) override {
-    bool status;
-
-    if (QFile::fileName() == "-") {
-      if (mode & QIODevice::WriteOnly) {
-        status = QFile::open(stdout, mode);
-      } else {
-        status = QFile::open(stdin, mode);
-      }
-    } else {
-      status =  QFile::open(mode);
-    }
+  bool open(OpenMode mode) override;
+  void close() override;
 
-    if (!status) {
-      gbFatal(FatalMsg().noquote() << "Cannot open '" %
-        (gpsbabel_testmode() ?
-          QFileInfo(*this).fileName() :
-          QFileInfo(*this).absoluteFilePath()) %
-        "' for " %
-        (mode & QIODevice::WriteOnly ? "write" : "read") %
-        ".  Error was '" %
-        QFile::errorString()  %
-        "'.");
+  QIODevice* device()
+  {
+#if !ZLIB_INHIBITED
+    if (gz_) {
+      return gz_.get();
     }
-    return status;
+#endif
+    return this;
   }
 
+private:
+#if !ZLIB_INHIBITED
+  std::unique_ptr<GzipDevice> gz_;
+#endif
 };
 
 } // namespace gpsbabel
@@ -0,0 +1,89 @@
+/*
+    Copyright (C) 2026 Robert Lipe, robertlipe+source@gpsbabel.org
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ */
+
+#if !ZLIB_INHIBITED
+
+#include <memory>              // for make_unique
+
+#include <QString>             // for QString
+
+#include "src/core/gzipdevice.h"
+#include "src/core/logging.h"  // for gbFatal, FatalMsg
+
+namespace gpsbabel
+{
+
+GzipDevice::~GzipDevice()
+{
+  /* ~QIODevice can't reach our close(). */
+  if (isOpen()) {
+    close();
+  }
+}
+
+bool GzipDevice::open(OpenMode mode)
+{
+  if (mode & QIODevice::WriteOnly) {
+    writer_ = std::make_unique<GzipWriter>(file_);
+  } else {
+    reader_ = std::make_unique<GzipReader>(file_);
+  }
+  return QIODevice::open(mode);
+}
+
+void GzipDevice::close()
+{
+  bool ok = !writer_ || writer_->finish();
+  QString error = writer_ ? writer_->errorString() : QString();
+  reader_.reset();
+  writer_.reset();
+  QIODevice::close();
+  if (!ok) {
+    gbFatal(FatalMsg().noquote() << "Could not write to" << file_->fileName() << "(" + error + ")");
+  }
+}
+
+bool GzipDevice::atEnd() const
+{
+  return QIODevice::atEnd() && (!reader_ || reader_->atEnd());
+}
+
+qint64 GzipDevice::readData(char* data, qint64 maxlen)
+{
+  qint64 result = reader_->read(data, maxlen);
+  if (result < 0) {
+    gbFatal(FatalMsg().noquote() << "zlib returned error" << reader_->error() <<
+            "(" + reader_->errorString() + ") reading" << file_->fileName());
+  }
+  return result;
+}
+
+qint64 GzipDevice::writeData(const char* data, qint64 len)
+{
+  qint64 result = writer_->write(data, len);
+  if (result < 0) {
+    gbFatal(FatalMsg().noquote() << "Could not write to" << file_->fileName() <<
+            "(" + writer_->errorString() + ")");
+  }
+  return result;
+}
+
+} // namespace gpsbabel
+
+#endif // !ZLIB_INHIBITED
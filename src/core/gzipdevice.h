@@ -0,0 +1,72 @@
+/*
+    Copyright (C) 2026 Robert Lipe, robertlipe+source@gpsbabel.org
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ */
+#ifndef SRC_CORE_GZIPDEVICE_H_
+#define SRC_CORE_GZIPDEVICE_H_
+
+#if !ZLIB_INHIBITED
+
+#include <memory>                  // for unique_ptr
+
+#include <QFile>                   // for QFile
+#include <QIODevice>               // for QIODevice
+#include <QtGlobal>                // for qint64
+
+#include "src/core/gzipstream.h"   // for GzipReader, GzipWriter
+
+namespace gpsbabel
+{
+
+/*
+ * A sequential device that decompresses what it reads from a gzip
+ * file, or compresses what is written to it.  The file must already
+ * be open in binary mode, and stays open when the device is closed.
+ * Text mode, if asked for, applies to the uncompressed side.
+ */
+class GzipDevice : public QIODevice
+{
+public:
+  explicit GzipDevice(QFile* file) : file_(file) {}
+  ~GzipDevice() override;
+  GzipDevice(const GzipDevice&) = delete;
+  GzipDevice& operator=(const GzipDevice&) = delete;
+
+  /* ReadOnly or WriteOnly, to match the file. */
+  bool open(OpenMode mode) override;
+  /* Writes the end of the gzip stream. */
+  void close() override;
+  bool isSequential() const override
+  {
+    return true;
+  }
+  bool atEnd() const override;
+
+protected:
+  qint64 readData(char* data, qint64 maxlen) override;
+  qint64 writeData(const char* data, qint64 len) override;
+
+private:
+  QFile* file_;
+  std::unique_ptr<GzipReader> reader_;
+  std::unique_ptr<GzipWriter> writer_;
+};
+
+} // namespace gpsbabel
+
+#endif // !ZLIB_INHIBITED
+#endif // SRC_CORE_GZIPDEVICE_H_
@@ -0,0 +1,564 @@
+/*
+    Copyright (C) 2026 Robert Lipe, robertlipe+source@gpsbabel.org
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ */
+
+#if !ZLIB_INHIBITED
+
+#include <algorithm>         // for max, min
+#include <cstdint>           // for uint32_t
+#include <cstring>           // for memcpy, memmove
+#include <utility>           // for move
+
+#include "src/core/gzipstream.h"
+
+namespace gpsbabel
+{
+
+/*******************************************************************************/
+/* %%%                            GzipReader                                %%% */
+/*******************************************************************************/
+
+GzipReader::GzipReader(QIODevice* source) :
+  source_(source)
+{
+  input_.resize(kInputSize);
+  strm_.next_in = reinterpret_cast<Bytef*>(input_.data());
+  strm_.avail_in = 0;
+}
+
+GzipReader::~GzipReader()
+{
+  stop();
+  if (inflate_init_) {
+    inflateEnd(&strm_);
+  }
+}
+
+void GzipReader::fail(int errnum, const QString& msg)
+{
+  errnum_ = errnum;
+  errmsg_ = msg;
+}
+
+/* Make sure at least want bytes of input are buffered, unless the source ends first. */
+bool GzipReader::fill_input(qsizetype want)
+{
+  qsizetype have = strm_.avail_in;
+  if ((have >= want) || source_end_) {
+    return have >= want;
+  }
+  if (have > 0) {
+    memmove(input_.data(), strm_.next_in, have);
+  }
+  while ((have < want) && !source_end_) {
+    qint64 n = source_->read(input_.data() + have, kInputSize - have);
+    if (n < 0) {
+      fail(Z_ERRNO, source_->errorString());
+      break;
+    }
+    if (n == 0) {
+      source_end_ = true;
+    }
+    have += n;
+  }
+  strm_.next_in = reinterpret_cast<Bytef*>(input_.data());
+  strm_.avail_in = have;
+  return have >= want;
+}
+
+/* Look at the magic bytes to decide whether we need to inflate at all. */
+bool GzipReader::detect()
+{
+  if (!fill_input(2) && (errnum_ != Z_OK)) {
+    return false;
+  }
+  if ((strm_.avail_in >= 2) && (strm_.next_in[0] == 0x1f) && (strm_.next_in[1] == 0x8b)) {
+    mode_ = Mode::gzip;
+    if (inflate_init_) {
+      inflateReset(&strm_);
+    } else if (inflateInit2(&strm_, 16 + MAX_WBITS) == Z_OK) {
+      inflate_init_ = true;
+    } else {
+      fail(Z_MEM_ERROR, QStringLiteral("cannot initialize zlib"));
+      return false;
+    }
+    member_end_ = false;
+  } else {
+    mode_ = Mode::transparent;
+  }
+  return true;
+}
+
+/* Decode up to maxlen bytes, 0 at the end and -1 on error. */
+qint64 GzipReader::decode(char* data, qint64 maxlen)
+{
+  if (errnum_ != Z_OK) {
+    return -1;
+  }
+  if ((mode_ == Mode::unknown) && !detect()) {
+    return -1;
+  }
+
+  qint64 produced = 0;
+  if (mode_ == Mode::transparent) {
+    if (strm_.avail_in > 0) {
+      qint64 n = std::min<qint64>(strm_.avail_in, maxlen);
+      memcpy(data, strm_.next_in, n);
+      strm_.next_in += n;
+      strm_.avail_in -= n;
+      produced = n;
+    }
+    /* Don't wait for more than the source has ready, it may be a live pipe. */
+    while ((produced == 0) && !source_end_) {
+      qint64 n = source_->read(data + produced, maxlen - produced);
+      if (n < 0) {
+        fail(Z_ERRNO, source_->errorString());
+        break;
+      }
+      if (n == 0) {
+        source_end_ = true;
+      }
+      produced += n;
+    }
+  } else {
+    while (produced < maxlen) {
+      if ((produced > 0) && (strm_.avail_in == 0) && source_->isSequential()) {
+        break;
+      }
+      if (member_end_) {
+        /* Like gzread, continue with a following member and ignore anything else. */
+        if (!fill_input(2) && (errnum_ != Z_OK)) {
+          break;
+        }
+        if ((strm_.avail_in < 2) || (strm_.next_in[0] != 0x1f) || (strm_.next_in[1] != 0x8b)) {
+          break;
+        }
+        inflateReset(&strm_);
+        member_end_ = false;
+      }
+      if ((strm_.avail_in == 0) && !fill_input(1)) {
+        if (errnum_ == Z_OK) {
+          fail(Z_BUF_ERROR, QStringLiteral("unexpected end of file"));
+        }
+        break;
+      }
+      strm_.next_out = reinterpret_cast<Bytef*>(data + produced);
+      strm_.avail_out = maxlen - produced;
+      int ret = inflate(&strm_, Z_NO_FLUSH);
+      produced = maxlen - strm_.avail_out;
+      if (ret == Z_STREAM_END) {
+        member_end_ = true;
+      } else if (ret != Z_OK) {
+        fail((ret == Z_NEED_DICT) ? Z_DATA_ERROR : ret,
+             (strm_.msg != nullptr) ? QString(strm_.msg) : QStringLiteral("compressed data error"));
+        break;
+      }
+    }
+  }
+  /* Hand out what we got before an error, the error sticks for the next call. */
+  if ((produced == 0) && (errnum_ != Z_OK)) {
+    return -1;
+  }
+  out_pos_ += produced;
+  return produced;
+}
+
+bool GzipReader::rewind()
+{
+  if ((errnum_ != Z_OK) || !source_->seek(0)) {
+    return false;
+  }
+  strm_.next_in = reinterpret_cast<Bytef*>(input_.data());
+  strm_.avail_in = 0;
+  source_end_ = false;
+  out_pos_ = 0;
+  mode_ = Mode::unknown;
+  return detect();
+}
+
+/* Runs on the helper thread. */
+void GzipReader::produce()
+{
+  for (;;) {
+    free_.acquire();
+    if (stop_) {
+      return;
+    }
+    Chunk& chunk = ring_[head_];
+    chunk.data.resize(kChunkSize);
+    qint64 n = decode(chunk.data.data(), kChunkSize);
+    if (n > 0) {
+      chunk.data.resize(n);
+      chunk.status = Status::data;
+    } else {
+      chunk.data.clear();
+      chunk.status = (n == 0) ? Status::end : Status::error;
+    }
+    head_ = (head_ + 1) % kChunks;
+    used_.release();
+    if (n <= 0) {
+      return;
+    }
+  }
+}
+
+void GzipReader::start()
+{
+  if (thread_ != nullptr) {
+    return;
+  }
+  stop_ = false;
+  thread_.reset(QThread::create([this]() {
+    produce();
+  }));
+  thread_->start();
+}
+
+/* Stop the helper and drop whatever it decoded ahead of us. */
+void GzipReader::stop()
+{
+  if (thread_ == nullptr) {
+    return;
+  }
+  stop_ = true;
+  free_.release();	/* wake the helper if the ring is full */
+  thread_->wait();
+  thread_.reset();
+
+  used_.acquire(used_.available());
+  free_.acquire(free_.available());
+  free_.release(kChunks);
+  head_ = 0;
+  tail_ = 0;
+  cur_ = nullptr;
+  cur_off_ = 0;
+  finished_ = false;
+}
+
+/* Make sure cur_ has unread data, returns false at the end or on error. */
+bool GzipReader::next_chunk()
+{
+  while ((cur_ == nullptr) || (cur_off_ >= cur_->data.size())) {
+    if (cur_ != nullptr) {
+      release_chunk();
+    }
+    if (finished_) {
+      return false;
+    }
+    start();
+    used_.acquire();
+    const Chunk& chunk = ring_[tail_];
+    if (chunk.status != Status::data) {
+      finished_ = true;
+      return false;
+    }
+    cur_ = &chunk;
+    cur_off_ = 0;
+  }
+  return true;
+}
+
+void GzipReader::release_chunk()
+{
+  cur_ = nullptr;
+  cur_off_ = 0;
+  tail_ = (tail_ + 1) % kChunks;
+  free_.release();
+}
+
+qint64 GzipReader::read(char* data, qint64 maxlen)
+{
+  qint64 total = 0;
+  while ((total < maxlen) && next_chunk()) {
+    qint64 n = std::min<qint64>(maxlen - total, cur_->data.size() - cur_off_);
+    memcpy(data + total, cur_->data.constData() + cur_off_, n);
+    cur_off_ += n;
+    total += n;
+    pos_ += n;
+  }
+  if ((total == 0) && finished_ && (errnum_ != Z_OK)) {
+    return -1;
+  }
+  return total;
+}
+
+bool GzipReader::atEnd()
+{
+  return !next_chunk();
+}
+
+bool GzipReader::seek(qint64 pos)
+{
+  if (pos < 0) {
+    return false;
+  }
+
+  /* Positions within the chunk at hand need no work at all. */
+  if (cur_ != nullptr) {
+    qint64 start = pos_ - cur_off_;
+    if ((pos >= start) && (pos <= start + cur_->data.size())) {
+      cur_off_ = pos - start;
+      pos_ = pos;
+      return true;
+    }
+  }
+
+  /* mode_ is stable once the helper has delivered a chunk, and we own it before that. */
+  if ((mode_ == Mode::unknown) && !detect()) {
+    return false;
+  }
+
+  if ((mode_ == Mode::transparent) && !source_->isSequential()) {
+    stop();
+    if (!source_->seek(pos)) {
+      return false;
+    }
+    strm_.next_in = reinterpret_cast<Bytef*>(input_.data());
+    strm_.avail_in = 0;
+    source_end_ = false;
+    out_pos_ = pos;
+    pos_ = pos;
+    return true;
+  }
+
+  /* Compressed data can only be decoded forward. */
+  if (pos < pos_) {
+    if (source_->isSequential()) {
+      return false;
+    }
+    stop();
+    if (!rewind()) {
+      return false;
+    }
+    pos_ = 0;
+  }
+  while ((pos_ < pos) && next_chunk()) {
+    qint64 n = std::min<qint64>(pos - pos_, cur_->data.size() - cur_off_);
+    cur_off_ += n;
+    pos_ += n;
+  }
+  if (pos_ < pos) {
+    if (errnum_ != Z_OK) {
+      return false;
+    }
+    /* As with gzseek, seeking beyond the end is not an error by itself. */
+    pos_ = pos;
+  }
+  return true;
+}
+
+/*******************************************************************************/
+/* %%%                            GzipWriter                                %%% */
+/*******************************************************************************/
+
+GzipWriter::GzipWriter(QIODevice* sink, int level) :
+  sink_(sink),
+  level_(level),
+  max_pending_(2 * std::max(1, QThread::idealThreadCount())),
+  crc_(crc32(0, nullptr, 0))
+{
+  buffer_.reserve(kBlockSize);
+}
+
+GzipWriter::~GzipWriter()
+{
+  if (!finished_) {
+    finish();
+  }
+  pool_.waitForDone();
+}
+
+/* Runs on the pool, one raw deflate stream per block. */
+void GzipWriter::compress(Block* block, int level)
+{
+  z_stream strm{};
+  if (deflateInit2(&strm, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    block->done.release();
+    return;
+  }
+  if (!block->dict.isEmpty()) {
+    deflateSetDictionary(&strm, reinterpret_cast<const Bytef*>(block->dict.constData()), block->dict.size());
+  }
+
+  strm.next_in = reinterpret_cast<Bytef*>(block->input.data());
+  strm.avail_in = block->input.size();
+  /* A sync flush appends an empty stored block to the bound. */
+  block->output.resize(deflateBound(&strm, strm.avail_in) + 16);
+  strm.next_out = reinterpret_cast<Bytef*>(block->output.data());
+  strm.avail_out = block->output.size();
+
+  /*
+   * All but the last block end with a sync flush, which leaves them
+   * byte aligned and not final, so they can simply be concatenated.
+   */
+  const int flush = block->last ? Z_FINISH : Z_SYNC_FLUSH;
+  for (;;) {
+    int ret = deflate(&strm, flush);
+    if (ret == Z_STREAM_ERROR) {
+      break;
+    }
+    if (block->last ? (ret == Z_STREAM_END) : (strm.avail_out != 0)) {
+      block->ok = true;
+      break;
+    }
+    qsizetype used = block->output.size() - strm.avail_out;
+    block->output.resize(2 * block->output.size());
+    strm.next_out = reinterpret_cast<Bytef*>(block->output.data() + used);
+    strm.avail_out = block->output.size() - used;
+  }
+  block->output.resize(block->output.size() - strm.avail_out);
+  deflateEnd(&strm);
+
+  block->crc = crc32(0, reinterpret_cast<const Bytef*>(block->input.constData()), block->input.size());
+  block->done.release();
+}
+
+void GzipWriter::submit(bool last)
+{
+  auto block = std::make_unique<Block>();
+  block->input = std::move(buffer_);
+  block->dict = dict_;
+  block->last = last;
+
+  /* The next block is primed with the tail of this one. */
+  if (block->input.size() >= kDictSize) {
+    dict_ = block->input.right(kDictSize);
+  } else {
+    dict_.append(block->input);
+    if (dict_.size() > kDictSize) {
+      dict_ = dict_.right(kDictSize);
+    }
+  }
+
+  Block* b = block.get();
+  const int level = level_;
+  pool_.start([b, level]() {
+    compress(b, level);
+  });
+  pending_.push_back(std::move(block));
+
+  buffer_ = QByteArray();
+  buffer_.reserve(kBlockSize);
+}
+
+/* Write finished blocks in order, waiting until no more than keep are in flight. */
+bool GzipWriter::drain(qsizetype keep)
+{
+  if (!header_written_) {
+    /* magic, deflate, no flags, no mtime, no extra flags, unknown OS */
+    static constexpr char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff'};
+    header_written_ = true;
+    if (!put(header, sizeof(header))) {
+      return false;
+    }
+  }
+
+  while (!pending_.empty()) {
+    Block& block = *pending_.front();
+    if (static_cast<qsizetype>(pending_.size()) > keep) {
+      block.done.acquire();
+    } else if (!block.done.tryAcquire()) {
+      break;
+    }
+    if (!block.ok) {
+      failed_ = true;
+      errmsg_ = QStringLiteral("compression failed");
+      return false;
+    }
+    if (!put(block.output.constData(), block.output.size())) {
+      return false;
+    }
+    crc_ = crc32_combine(crc_, block.crc, block.input.size());
+    pending_.pop_front();
+  }
+  return true;
+}
+
+bool GzipWriter::put(const char* data, qint64 len)
+{
+  while (len > 0) {
+    qint64 n = sink_->write(data, len);
+    if (n <= 0) {
+      failed_ = true;
+      errmsg_ = sink_->errorString();
+      return false;
+    }
+    data += n;
+    len -= n;
+  }
+  return true;
+}
+
+qint64 GzipWriter::write(const char* data, qint64 len)
+{
+  if (finished_ || failed_) {
+    return -1;
+  }
+  qint64 done = 0;
+  while (done < len) {
+    qint64 n = std::min<qint64>(len - done, kBlockSize - buffer_.size());
+    buffer_.append(data + done, n);
+    done += n;
+    if (buffer_.size() == kBlockSize) {
+      submit(false);
+      if (!drain(max_pending_)) {
+        return -1;
+      }
+    }
+  }
+  total_ += len;
+  return len;
+}
+
+bool GzipWriter::flush()
+{
+  if (finished_ || failed_) {
+    return false;
+  }
+  if (!buffer_.isEmpty()) {
+    submit(false);
+  }
+  return drain(0);
+}
+
+bool GzipWriter::finish()
+{
+  if (finished_) {
+    return !failed_;
+  }
+  finished_ = true;
+  if (failed_) {
+    return false;
+  }
+  submit(true);
+  if (!drain(0)) {
+    return false;
+  }
+
+  char trailer[8];
+  const auto isize = static_cast<uint32_t>(total_);
+  for (int i = 0; i < 4; ++i) {
+    trailer[i] = static_cast<char>((crc_ >> (8 * i)) & 0xff);
+    trailer[4 + i] = static_cast<char>((isize >> (8 * i)) & 0xff);
+  }
+  return put(trailer, sizeof(trailer));
+}
+
+} // namespace gpsbabel
+
+#endif // !ZLIB_INHIBITED
@@ -0,0 +1,204 @@
+/*
+    Copyright (C) 2026 Robert Lipe, robertlipe+source@gpsbabel.org
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ */
+#ifndef SRC_CORE_GZIPSTREAM_H_
+#define SRC_CORE_GZIPSTREAM_H_
+
+#if !ZLIB_INHIBITED
+
+#include <array>            // for array
+#include <atomic>           // for atomic
+#include <deque>            // for deque
+#include <memory>           // for unique_ptr
+
+#include <QByteArray>       // for QByteArray
+#include <QIODevice>        // for QIODevice
+#include <QSemaphore>       // for QSemaphore
+#include <QString>          // for QString
+#include <QThread>          // for QThread
+#include <QThreadPool>      // for QThreadPool
+#include <QtGlobal>         // for qint64
+
+#if HAVE_LIBZ
+#include <zlib.h>
+#else
+#include "zlib.h"
+#endif
+
+namespace gpsbabel
+{
+
+/*
+ * Reads a gzip file, or an uncompressed file transparently, from a
+ * QIODevice.  Decompression runs on a helper thread that stays a few
+ * chunks ahead of the consumer, so inflating and parsing overlap.
+ * Concatenated gzip members are read as one stream.
+ *
+ * The source device must stay open and must not be touched by anyone
+ * else until the reader is destroyed.
+ */
+class GzipReader
+{
+public:
+  explicit GzipReader(QIODevice* source);
+  ~GzipReader();
+  GzipReader(const GzipReader&) = delete;
+  GzipReader& operator=(const GzipReader&) = delete;
+
+  /* Returns the number of bytes read, 0 at the end, -1 on error. */
+  qint64 read(char* data, qint64 maxlen);
+  /* Seeking backwards in compressed data restarts from the beginning. */
+  bool seek(qint64 pos);
+  qint64 pos() const
+  {
+    return pos_;
+  }
+  bool atEnd();
+  /* zlib error code of the last failure, Z_OK if there was none. */
+  int error() const
+  {
+    return errnum_;
+  }
+  QString errorString() const
+  {
+    return errmsg_;
+  }
+
+private:
+  enum class Mode {unknown, transparent, gzip};
+  enum class Status {data, end, error};
+
+  struct Chunk {
+    QByteArray data;
+    Status status{Status::data};
+  };
+
+  /* Members used by the helper thread, only touched by the consumer while it is stopped. */
+  void produce();
+  qint64 decode(char* data, qint64 maxlen);
+  bool detect();
+  bool fill_input(qsizetype want);
+  void fail(int errnum, const QString& msg);
+  bool rewind();
+
+  /* Members used by the consumer. */
+  void start();
+  void stop();
+  bool next_chunk();
+  void release_chunk();
+
+  static constexpr int kChunks = 4;
+  static constexpr qsizetype kChunkSize = 256 * 1024;
+  static constexpr qsizetype kInputSize = 64 * 1024;
+
+  QIODevice* source_;
+  Mode mode_{Mode::unknown};
+  z_stream strm_{};
+  bool inflate_init_{false};
+  bool member_end_{false};
+  bool source_end_{false};
+  QByteArray input_;
+  qint64 out_pos_{0};	/* decoded position of the helper thread */
+  int errnum_{Z_OK};
+  QString errmsg_;
+
+  std::array<Chunk, kChunks> ring_;
+  QSemaphore free_{kChunks};
+  QSemaphore used_{0};
+  std::atomic<bool> stop_{false};
+  std::unique_ptr<QThread> thread_;
+  int head_{0};	/* next chunk the helper fills */
+  int tail_{0};	/* chunk the consumer reads */
+  const Chunk* cur_{nullptr};
+  qsizetype cur_off_{0};
+  bool finished_{false};	/* the consumer has seen the end or an error */
+  qint64 pos_{0};
+};
+
+/*
+ * Writes a standard gzip file to a QIODevice, compressing independent
+ * blocks in parallel like pigz.  Each block is primed with the last
+ * 32 KiB of the previous one, so the ratio is close to that of a single
+ * deflate stream.  Blocks are written in order as they complete.
+ */
+class GzipWriter
+{
+public:
+  explicit GzipWriter(QIODevice* sink, int level = Z_DEFAULT_COMPRESSION);
+  ~GzipWriter();
+  GzipWriter(const GzipWriter&) = delete;
+  GzipWriter& operator=(const GzipWriter&) = delete;
+
+  /* Returns len, or -1 on error. */
+  qint64 write(const char* data, qint64 len);
+  /* Compress and write everything buffered, the stream stays open. */
+  bool flush();
+  /* Write the last block and the trailer, further writes fail. */
+  bool finish();
+  qint64 pos() const
+  {
+    return total_;
+  }
+  /* Z_ERRNO after a failure, Z_OK otherwise. */
+  int error() const
+  {
+    return failed_ ? Z_ERRNO : Z_OK;
+  }
+  QString errorString() const
+  {
+    return errmsg_;
+  }
+
+private:
+  struct Block {
+    QByteArray input;
+    QByteArray dict;
+    QByteArray output;
+    uLong crc{0};
+    bool last{false};
+    bool ok{false};
+    QSemaphore done;
+  };
+
+  static void compress(Block* block, int level);
+  void submit(bool last);
+  bool drain(qsizetype keep);
+  bool put(const char* data, qint64 len);
+
+  static constexpr qsizetype kBlockSize = 128 * 1024;
+  static constexpr qsizetype kDictSize = 32 * 1024;
+
+  QIODevice* sink_;
+  int level_;
+  QThreadPool pool_;
+  std::deque<std::unique_ptr<Block>> pending_;
+  qsizetype max_pending_;
+  QByteArray buffer_;
+  QByteArray dict_;
+  uLong crc_;
+  qint64 total_{0};
+  bool header_written_{false};
+  bool finished_{false};
+  bool failed_{false};
+  QString errmsg_;
+};
+
+} // namespace gpsbabel
+
+#endif // !ZLIB_INHIBITED
+#endif // SRC_CORE_GZIPSTREAM_H_
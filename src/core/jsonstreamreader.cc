@@ -0,0 +1,446 @@
+/*
+    Copyright (C) 2026 Robert Lipe, robertlipe+source@gpsbabel.org
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ */
+
+#include <cstring>           // for memchr, memmove, strlen, strncmp
+
+#include <QChar>             // for QChar
+#include <QJsonArray>        // for QJsonArray
+#include <QJsonObject>       // for QJsonObject
+#include <Qt>                // for Uninitialized
+
+#include "src/core/jsonstreamreader.h"
+
+namespace gpsbabel
+{
+
+JsonStreamReader::JsonStreamReader(QIODevice* device) :
+  device_(device),
+  buffer_(kBufferSize, Qt::Uninitialized)
+{
+}
+
+JsonStreamReader::TokenType JsonStreamReader::fail(const char* msg)
+{
+  error_ = QString::fromLatin1(msg);
+  return token_ = Invalid;
+}
+
+/* Read more input, keeping whatever hasn't been consumed yet. */
+bool JsonStreamReader::fill()
+{
+  if (eof_) {
+    return false;
+  }
+  if (pos_ > 0) {
+    memmove(buffer_.data(), buffer_.constData() + pos_, end_ - pos_);
+    end_ -= pos_;
+    pos_ = 0;
+  }
+  qint64 n = device_->read(buffer_.data() + end_, kBufferSize - end_);
+  if (n <= 0) {
+    eof_ = true;
+    return false;
+  }
+  end_ += n;
+  return true;
+}
+
+/* Make sure at least n bytes are buffered, unless the input ends first. */
+bool JsonStreamReader::require(qsizetype n)
+{
+  while (end_ - pos_ < n) {
+    if (!fill()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Returns the next character that isn't white space without consuming it, -1 at the end. */
+int JsonStreamReader::skipSpace()
+{
+  for (;;) {
+    while (pos_ < end_) {
+      char c = buffer_.at(pos_);
+      if ((c != ' ') && (c != '\t') && (c != '\n') && (c != '\r')) {
+        return static_cast<unsigned char>(c);
+      }
+      ++pos_;
+    }
+    if (!fill()) {
+      return -1;
+    }
+  }
+}
+
+JsonStreamReader::TokenType JsonStreamReader::readNext()
+{
+  if ((token_ == Invalid) || (token_ == EndDocument)) {
+    return token_;
+  }
+
+  if (state_ == State::start) {
+    if (require(3) && (strncmp(buffer_.constData() + pos_, "\xef\xbb\xbf", 3) == 0)) {
+      pos_ += 3;
+    }
+  }
+
+  int c = skipSpace();
+  switch (state_) {
+  case State::start:
+    if (c < 0) {
+      return fail("illegal value");
+    }
+    return startValue(c);
+
+  case State::object_first:
+    if (c == '}') {
+      return closeContainer('}');
+    }
+    [[fallthrough]];
+  case State::object_name:
+    if (c != '"') {
+      return fail((c < 0) ? "unterminated object" : "object is missing after a comma");
+    }
+    ++pos_;
+    if (!parseString(name_)) {
+      return token_;
+    }
+    if (skipSpace() != ':') {
+      return fail("missing name separator");
+    }
+    ++pos_;
+    state_ = State::value;
+    return token_ = Name;
+
+  case State::array_first:
+    if (c == ']') {
+      return closeContainer(']');
+    }
+    [[fallthrough]];
+  case State::value:
+    if (c < 0) {
+      return fail((stack_.back() == '[') ? "unterminated array" : "unterminated object");
+    }
+    return startValue(c);
+
+  case State::next:
+    if (c == ',') {
+      ++pos_;
+      state_ = (stack_.back() == '{') ? State::object_name : State::value;
+      return readNext();
+    }
+    if ((c == '}') && (stack_.back() == '{')) {
+      return closeContainer('}');
+    }
+    if ((c == ']') && (stack_.back() == '[')) {
+      return closeContainer(']');
+    }
+    if (c < 0) {
+      return fail((stack_.back() == '[') ? "unterminated array" : "unterminated object");
+    }
+    return fail((stack_.back() == '[') ? "missing value separator" : "unterminated object");
+
+  case State::done:
+    if (c >= 0) {
+      return fail("garbage at the end of the document");
+    }
+    return token_ = EndDocument;
+  }
+  return fail("illegal value");
+}
+
+JsonStreamReader::TokenType JsonStreamReader::startValue(int c)
+{
+  switch (c) {
+  case '{':
+  case '[':
+    if (stack_.size() >= kMaxDepth) {
+      return fail("too deeply nested document");
+    }
+    ++pos_;
+    stack_.push_back(static_cast<char>(c));
+    if (c == '{') {
+      state_ = State::object_first;
+      return token_ = StartObject;
+    }
+    state_ = State::array_first;
+    return token_ = StartArray;
+  case '"': {
+    ++pos_;
+    QString str;
+    if (!parseString(str)) {
+      return token_;
+    }
+    value_ = str;
+    break;
+  }
+  case 't':
+    if (!parseLiteral("true", QJsonValue(true))) {
+      return token_;
+    }
+    break;
+  case 'f':
+    if (!parseLiteral("false", QJsonValue(false))) {
+      return token_;
+    }
+    break;
+  case 'n':
+    if (!parseLiteral("null", QJsonValue(QJsonValue::Null))) {
+      return token_;
+    }
+    break;
+  default:
+    if ((c != '-') && ((c < '0') || (c > '9'))) {
+      return fail("illegal value");
+    }
+    if (!parseNumber()) {
+      return token_;
+    }
+    break;
+  }
+  endValue();
+  return token_ = Value;
+}
+
+JsonStreamReader::TokenType JsonStreamReader::closeContainer(char c)
+{
+  ++pos_;
+  stack_.pop_back();
+  endValue();
+  return token_ = (c == '}') ? EndObject : EndArray;
+}
+
+void JsonStreamReader::endValue()
+{
+  state_ = stack_.empty() ? State::done : State::next;
+}
+
+/* Parse a string whose opening quote has been consumed. */
+bool JsonStreamReader::parseString(QString& out)
+{
+  /*
+   * Runs of plain text are collected as bytes, so a UTF-8 sequence
+   * split across reads is decoded whole.  Escapes are ASCII and never
+   * split one.
+   */
+  QByteArray run;
+  out.clear();
+  for (;;) {
+    qsizetype start = pos_;
+    while ((pos_ < end_) && (buffer_.at(pos_) != '"') && (buffer_.at(pos_) != '\\')) {
+      ++pos_;
+    }
+    run.append(buffer_.constData() + start, pos_ - start);
+    if (pos_ == end_) {
+      if (!fill()) {
+        fail("unterminated string");
+        return false;
+      }
+      continue;
+    }
+    if (buffer_.at(pos_++) == '"') {
+      out += QString::fromUtf8(run);
+      return true;
+    }
+
+    out += QString::fromUtf8(run);
+    run.clear();
+    if (!require(1)) {
+      fail("unterminated string");
+      return false;
+    }
+    char esc = buffer_.at(pos_++);
+    switch (esc) {
+    case '"':
+    case '\\':
+    case '/':
+      out += QChar::fromLatin1(esc);
+      break;
+    case 'b':
+      out += QChar(u'\b');
+      break;
+    case 'f':
+      out += QChar(u'\f');
+      break;
+    case 'n':
+      out += QChar(u'\n');
+      break;
+    case 'r':
+      out += QChar(u'\r');
+      break;
+    case 't':
+      out += QChar(u'\t');
+      break;
+    case 'u': {
+      if (!require(4)) {
+        fail("unterminated string");
+        return false;
+      }
+      char16_t code = 0;
+      for (int i = 0; i < 4; ++i) {
+        char h = buffer_.at(pos_++);
+        code <<= 4;
+        if ((h >= '0') && (h <= '9')) {
+          code |= h - '0';
+        } else if ((h >= 'a') && (h <= 'f')) {
+          code |= h - 'a' + 10;
+        } else if ((h >= 'A') && (h <= 'F')) {
+          code |= h - 'A' + 10;
+        } else {
+          fail("invalid escape sequence");
+          return false;
+        }
+      }
+      /* Surrogate pairs arrive as two escapes, one UTF-16 unit each. */
+      out += QChar(code);
+      break;
+    }
+    default:
+      fail("invalid escape sequence");
+      return false;
+    }
+  }
+}
+
+bool JsonStreamReader::parseNumber()
+{
+  QByteArray text;
+  for (;;) {
+    qsizetype start = pos_;
+    while (pos_ < end_) {
+      char c = buffer_.at(pos_);
+      if (((c < '0') || (c > '9')) && (c != '-') && (c != '+') &&
+          (c != '.') && (c != 'e') && (c != 'E')) {
+        break;
+      }
+      ++pos_;
+    }
+    text.append(buffer_.constData() + start, pos_ - start);
+    if ((pos_ < end_) || !fill()) {
+      break;
+    }
+  }
+
+  /* -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? */
+  const char* p = text.constData();
+  const char* e = p + text.size();
+  auto digits = [&p, e]()->int {
+    int n = 0;
+    while ((p < e) && (*p >= '0') && (*p <= '9')) {
+      ++p;
+      ++n;
+    }
+    return n;
+  };
+  bool integral = true;
+  if (*p == '-') {
+    ++p;
+  }
+  int n = digits();
+  bool ok = (n == 1) || ((n > 1) && (p[-n] != '0'));
+  if (ok && (p < e) && (*p == '.')) {
+    ++p;
+    integral = false;
+    ok = digits() > 0;
+  }
+  if (ok && (p < e) && ((*p == 'e') || (*p == 'E'))) {
+    ++p;
+    integral = false;
+    if ((p < e) && ((*p == '+') || (*p == '-'))) {
+      ++p;
+    }
+    ok = digits() > 0;
+  }
+  if (!ok || (p != e)) {
+    fail("illegal number");
+    return false;
+  }
+
+  if (integral) {
+    qint64 i = text.toLongLong(&ok);
+    if (ok) {
+      value_ = QJsonValue(i);
+      return true;
+    }
+  }
+  value_ = QJsonValue(text.toDouble());
+  return true;
+}
+
+bool JsonStreamReader::parseLiteral(const char* word, const QJsonValue& literal)
+{
+  auto len = static_cast<qsizetype>(strlen(word));
+  if (!require(len) || (strncmp(buffer_.constData() + pos_, word, len) != 0)) {
+    fail("illegal value");
+    return false;
+  }
+  pos_ += len;
+  value_ = literal;
+  return true;
+}
+
+QJsonValue JsonStreamReader::readValue()
+{
+  switch (token_) {
+  case Value:
+    return value_;
+  case StartObject: {
+    QJsonObject object;
+    while (readNext() == Name) {
+      const QString key = name_;
+      readNext();
+      QJsonValue member = readValue();
+      if (hasError()) {
+        return {};
+      }
+      object.insert(key, member);
+    }
+    return hasError() ? QJsonValue() : QJsonValue(object);
+  }
+  case StartArray: {
+    QJsonArray array;
+    while (readNext() != EndArray) {
+      QJsonValue element = readValue();
+      if (hasError()) {
+        return {};
+      }
+      array.append(element);
+    }
+    return array;
+  }
+  default:
+    return {};
+  }
+}
+
+void JsonStreamReader::skipValue()
+{
+  if ((token_ != StartObject) && (token_ != StartArray)) {
+    return;
+  }
+  const std::size_t depth = stack_.size();
+  while (stack_.size() >= depth) {
+    if (readNext() == Invalid) {
+      return;
+    }
+  }
+}
+
+} // namespace gpsbabel
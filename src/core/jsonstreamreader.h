@@ -0,0 +1,118 @@
+/*
+    Copyright (C) 2026 Robert Lipe, robertlipe+source@gpsbabel.org
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ */
+#ifndef SRC_CORE_JSONSTREAMREADER_H_
+#define SRC_CORE_JSONSTREAMREADER_H_
+
+#include <vector>          // for vector
+
+#include <QByteArray>      // for QByteArray
+#include <QIODevice>       // for QIODevice
+#include <QJsonValue>      // for QJsonValue
+#include <QString>         // for QString
+#include <QtGlobal>        // for qsizetype, qint64
+
+namespace gpsbabel
+{
+
+/*
+ * A pull parser for JSON in the spirit of QXmlStreamReader.  The
+ * document is read from the device in small blocks and reported one
+ * token at a time, so a huge array can be walked element by element
+ * with readValue(), holding only the current element in memory.
+ *
+ * Error messages are those of QJsonParseError.
+ */
+class JsonStreamReader
+{
+public:
+  enum TokenType {
+    NoToken,
+    Invalid,
+    StartObject,
+    EndObject,
+    StartArray,
+    EndArray,
+    Name,	/* an object key, the next token starts its value */
+    Value,	/* a string, number, bool or null */
+    EndDocument
+  };
+
+  explicit JsonStreamReader(QIODevice* device);
+
+  TokenType readNext();
+  TokenType tokenType() const
+  {
+    return token_;
+  }
+  /* The key of a Name token. */
+  QString name() const
+  {
+    return name_;
+  }
+  /* The scalar of a Value token. */
+  QJsonValue value() const
+  {
+    return value_;
+  }
+  /* Consume the whole value starting at the current token and return it. */
+  QJsonValue readValue();
+  /* Like readValue(), without building anything. */
+  void skipValue();
+  bool hasError() const
+  {
+    return token_ == Invalid;
+  }
+  QString errorString() const
+  {
+    return error_;
+  }
+
+private:
+  enum class State {start, object_first, object_name, array_first, value, next, done};
+
+  TokenType fail(const char* msg);
+  TokenType startValue(int c);
+  TokenType closeContainer(char c);
+  void endValue();
+  bool fill();
+  bool require(qsizetype n);
+  int skipSpace();
+  bool parseString(QString& out);
+  bool parseNumber();
+  bool parseLiteral(const char* word, const QJsonValue& literal);
+
+  static constexpr qsizetype kBufferSize = 64 * 1024;
+  static constexpr std::size_t kMaxDepth = 1024;
+
+  QIODevice* device_;
+  QByteArray buffer_;
+  qsizetype pos_{0};
+  qsizetype end_{0};
+  bool eof_{false};
+  std::vector<char> stack_;	/* '{' or '[' for each open container */
+  State state_{State::start};
+  TokenType token_{NoToken};
+  QString name_;
+  QJsonValue value_;
+  QString error_;
+};
+
+} // namespace gpsbabel
+
+#endif // SRC_CORE_JSONSTREAMREADER_H_
@@ -0,0 +1,291 @@
+/*
+    Copyright (C) 2026 Robert Lipe, robertlipe+source@gpsbabel.org
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ */
+
+#include <charconv>          // for to_chars, from_chars
+#include <cmath>             // for fabs, isfinite, trunc
+#include <cstdlib>           // for abs
+
+#include <QChar>             // for QChar
+
+#include "src/core/jsonstreamwriter.h"
+
+namespace gpsbabel
+{
+
+JsonStreamWriter::JsonStreamWriter(QIODevice* device, Style style) :
+  device_(device),
+  compact_(style != Style::Indented),
+  lines_(style == Style::Lines)
+{
+  buffer_.reserve(kFlushSize + 4096);
+}
+
+JsonStreamWriter::~JsonStreamWriter()
+{
+  flush();
+}
+
+void JsonStreamWriter::flush()
+{
+  if (!buffer_.isEmpty()) {
+    device_->write(buffer_);
+    buffer_.clear();
+  }
+}
+
+/* Start a new element of the current container on a line of its own. */
+void JsonStreamWriter::separate()
+{
+  Level& top = stack_.back();
+  if (top.count++ > 0) {
+    buffer_.append(compact_ ? "," : ",\n");
+  }
+  if (!compact_) {
+    buffer_.append(static_cast<qsizetype>(4 * stack_.size()), ' ');
+  }
+}
+
+void JsonStreamWriter::beginValue()
+{
+  if (name_pending_) {
+    name_pending_ = false;
+  } else if (!stack_.empty()) {
+    separate();
+  }
+}
+
+void JsonStreamWriter::endValue()
+{
+  if (stack_.empty()) {
+    if (!compact_ || lines_) {
+      buffer_.append('\n');
+    }
+    flush();
+  } else if (buffer_.size() >= kFlushSize) {
+    flush();
+  }
+}
+
+void JsonStreamWriter::writeStartObject()
+{
+  beginValue();
+  buffer_.append(compact_ ? "{" : "{\n");
+  stack_.push_back({true, 0});
+}
+
+void JsonStreamWriter::writeStartArray()
+{
+  beginValue();
+  buffer_.append(compact_ ? "[" : "[\n");
+  stack_.push_back({false, 0});
+}
+
+void JsonStreamWriter::writeEnd(char c)
+{
+  const Level top = stack_.back();
+  stack_.pop_back();
+  if (!compact_) {
+    if (top.count > 0) {
+      buffer_.append('\n');
+    }
+    buffer_.append(static_cast<qsizetype>(4 * stack_.size()), ' ');
+  }
+  buffer_.append(c);
+  endValue();
+}
+
+void JsonStreamWriter::writeEndObject()
+{
+  writeEnd('}');
+}
+
+void JsonStreamWriter::writeEndArray()
+{
+  writeEnd(']');
+}
+
+void JsonStreamWriter::writeName(const QString& name)
+{
+  separate();
+  appendString(buffer_, name);
+  buffer_.append(compact_ ? ":" : ": ");
+  name_pending_ = true;
+}
+
+void JsonStreamWriter::writeString(const QString& str)
+{
+  beginValue();
+  appendString(buffer_, str);
+  endValue();
+}
+
+void JsonStreamWriter::writeDouble(double d)
+{
+  beginValue();
+  appendDouble(buffer_, d);
+  endValue();
+}
+
+void JsonStreamWriter::appendDouble(QByteArray& out, double d)
+{
+  if (!std::isfinite(d)) {
+    out.append("null");
+    return;
+  }
+
+  char buf[32];
+  /* Integral values print as integers, QJsonValue keeps them that way. */
+  if ((d == std::trunc(d)) && (std::fabs(d) <= 9007199254740992.0)) {
+    auto res = std::to_chars(buf, buf + sizeof(buf), static_cast<long long>(d));
+    out.append(buf, res.ptr - buf);
+    return;
+  }
+
+  /* The shortest digits that round trip, as d.ddde[+-]x */
+  auto res = std::to_chars(buf, buf + sizeof(buf), d, std::chars_format::scientific);
+  const char* p = buf;
+  if (*p == '-') {
+    out.append('-');
+    ++p;
+  }
+  char digits[24];
+  int ndigits = 0;
+  for (; *p != 'e'; ++p) {
+    if (*p != '.') {
+      digits[ndigits++] = *p;
+    }
+  }
+  ++p;
+  if (*p == '+') {
+    ++p;
+  }
+  int exponent = 0;
+  std::from_chars(p, res.ptr, exponent);
+  const int decpt = exponent + 1;
+
+  /* QLocaleData::doubleToString() picks the form for FloatingPointShortest like this. */
+  constexpr int bias = 4;
+  bool decimal;
+  if (decpt <= 0) {
+    decimal = 1 - decpt <= bias;
+  } else if (decpt <= ndigits) {
+    decimal = true;
+  } else {
+    decimal = decpt <= ndigits + bias;
+  }
+
+  if (decimal) {
+    if (decpt <= 0) {
+      out.append("0.");
+      out.append(-decpt, '0');
+      out.append(digits, ndigits);
+    } else if (decpt < ndigits) {
+      out.append(digits, decpt);
+      out.append('.');
+      out.append(digits + decpt, ndigits - decpt);
+    } else {
+      out.append(digits, ndigits);
+      out.append(decpt - ndigits, '0');
+    }
+  } else {
+    out.append(digits[0]);
+    if (ndigits > 1) {
+      out.append('.');
+      out.append(digits + 1, ndigits - 1);
+    }
+    out.append((exponent < 0) ? "e-" : "e+");
+    if (std::abs(exponent) < 10) {
+      out.append('0');
+    }
+    res = std::to_chars(buf, buf + sizeof(buf), std::abs(exponent));
+    out.append(buf, res.ptr - buf);
+  }
+}
+
+/* Escape like QJsonDocument: control characters, quote and backslash, and unpaired surrogates. */
+void JsonStreamWriter::appendString(QByteArray& out, const QString& str)
+{
+  static constexpr char hex[] = "0123456789abcdef";
+  auto escape = [&out](char16_t u)->void {
+    out.append("\\u");
+    out.append(hex[(u >> 12) & 0xf]);
+    out.append(hex[(u >> 8) & 0xf]);
+    out.append(hex[(u >> 4) & 0xf]);
+    out.append(hex[u & 0xf]);
+  };
+
+  out.append('"');
+  const QChar* src = str.constData();
+  const QChar* end = src + str.size();
+  while (src != end) {
+    char16_t u = src->unicode();
+    ++src;
+    if (u < 0x80) {
+      if ((u >= 0x20) && (u != '"') && (u != '\\')) {
+        out.append(static_cast<char>(u));
+        continue;
+      }
+      switch (u) {
+      case '"':
+        out.append("\\\"");
+        break;
+      case '\\':
+        out.append("\\\\");
+        break;
+      case '\b':
+        out.append("\\b");
+        break;
+      case '\f':
+        out.append("\\f");
+        break;
+      case '\n':
+        out.append("\\n");
+        break;
+      case '\r':
+        out.append("\\r");
+        break;
+      case '\t':
+        out.append("\\t");
+        break;
+      default:
+        escape(u);
+        break;
+      }
+    } else if (u < 0x800) {
+      out.append(static_cast<char>(0xc0 | (u >> 6)));
+      out.append(static_cast<char>(0x80 | (u & 0x3f)));
+    } else if (!QChar::isSurrogate(u)) {
+      out.append(static_cast<char>(0xe0 | (u >> 12)));
+      out.append(static_cast<char>(0x80 | ((u >> 6) & 0x3f)));
+      out.append(static_cast<char>(0x80 | (u & 0x3f)));
+    } else if (QChar::isHighSurrogate(u) && (src != end) && src->isLowSurrogate()) {
+      char32_t c = QChar::surrogateToUcs4(u, src->unicode());
+      ++src;
+      out.append(static_cast<char>(0xf0 | (c >> 18)));
+      out.append(static_cast<char>(0x80 | ((c >> 12) & 0x3f)));
+      out.append(static_cast<char>(0x80 | ((c >> 6) & 0x3f)));
+      out.append(static_cast<char>(0x80 | (c & 0x3f)));
+    } else {
+      escape(u);
+    }
+  }
+  out.append('"');
+}
+
+} // namespace gpsbabel
@@ -0,0 +1,89 @@
+/*
+    Copyright (C) 2026 Robert Lipe, robertlipe+source@gpsbabel.org
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ */
+#ifndef SRC_CORE_JSONSTREAMWRITER_H_
+#define SRC_CORE_JSONSTREAMWRITER_H_
+
+#include <vector>          // for vector
+
+#include <QByteArray>      // for QByteArray
+#include <QIODevice>       // for QIODevice
+#include <QString>         // for QString
+#include <QtGlobal>        // for qsizetype
+
+namespace gpsbabel
+{
+
+/*
+ * Writes JSON to a QIODevice as it is produced, the counterpart of
+ * JsonStreamReader.  The layout is that of QJsonDocument::toJson(), so
+ * a document written in key order is byte for byte what QJsonDocument
+ * would have made of it.  Lines writes each top level value compactly
+ * on a line of its own, as in newline delimited JSON.
+ *
+ * Callers are trusted to nest correctly and to name object members.
+ */
+class JsonStreamWriter
+{
+public:
+  enum class Style {Indented, Compact, Lines};
+
+  explicit JsonStreamWriter(QIODevice* device, Style style = Style::Indented);
+  ~JsonStreamWriter();
+  JsonStreamWriter(const JsonStreamWriter&) = delete;
+  JsonStreamWriter& operator=(const JsonStreamWriter&) = delete;
+
+  void writeStartObject();
+  void writeEndObject();
+  void writeStartArray();
+  void writeEndArray();
+  /* Starts an object member, the next value written is its value. */
+  void writeName(const QString& name);
+  void writeString(const QString& str);
+  /* Non-finite numbers are written as null, as QJsonDocument does. */
+  void writeDouble(double d);
+  void flush();
+
+  /* Append the shortest text that reads back as d, formatted like QByteArray::number(d, 'g', QLocale::FloatingPointShortest). */
+  static void appendDouble(QByteArray& out, double d);
+  static void appendString(QByteArray& out, const QString& str);
+
+private:
+  struct Level {
+    bool object;
+    int count;
+  };
+
+  void beginValue();
+  void endValue();
+  void separate();
+  void writeEnd(char c);
+
+  static constexpr qsizetype kFlushSize = 64 * 1024;
+
+  QIODevice* device_;
+  bool compact_;
+  bool lines_;
+  bool name_pending_{false};
+  std::vector<Level> stack_;
+  QByteArray buffer_;
+};
+
+} // namespace gpsbabel
+
+#endif // SRC_CORE_JSONSTREAMWRITER_H_
@@ -0,0 +1,185 @@
+/*
+    Copyright (C) 2026 Robert Lipe, robertlipe+source@gpsbabel.org
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ */
+#ifndef SRC_CORE_KEYSORT_H_
+#define SRC_CORE_KEYSORT_H_
+
+// Stable sorting of large sequences by a key that is extracted once
+// per element, instead of on every comparison.  Integer keys are radix
+// sorted, other keys are merge sorted in parallel.  Either way the
+// result is identical to std::stable_sort with the equivalent comparator.
+
+#include <algorithm>         // for stable_sort, merge, min
+#include <array>             // for array
+#include <cstddef>           // for size_t
+#include <cstdint>           // for uint64_t, int64_t
+#include <iterator>          // for iterator_traits
+#include <type_traits>       // for invoke_result_t, decay_t, is_integral_v, is_signed_v
+#include <utility>           // for pair, move
+#include <vector>            // for vector
+
+#include <QThread>           // for QThread
+#include <QThreadPool>       // for QThreadPool
+
+
+namespace gpsbabel
+{
+
+namespace keysort_detail
+{
+
+// Below this size the bookkeeping of the fancier sorts doesn't pay off.
+inline constexpr std::size_t kSmallSort = 256;
+inline constexpr std::size_t kParallelSort = 64 * 1024;
+
+// LSD radix sort on 8 bit digits, stable by construction.
+// Digits on which all keys agree (e.g. the high bytes of timestamps)
+// are skipped.
+template <typename Key, typename T>
+void radix_sort(std::vector<std::pair<Key, T>>& items)
+{
+  const std::size_t n = items.size();
+  std::vector<std::uint64_t> keys(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    // Flip the sign bit so that signed keys order correctly as unsigned.
+    keys[i] = static_cast<std::uint64_t>(static_cast<std::int64_t>(items[i].first)) ^ (std::uint64_t{1} << 63);
+  }
+
+  std::vector<std::pair<Key, T>> items_tmp(n);
+  std::vector<std::uint64_t> keys_tmp(n);
+  for (int shift = 0; shift < 64; shift += 8) {
+    std::array<std::size_t, 257> offsets{};
+    for (std::size_t i = 0; i < n; ++i) {
+      ++offsets[((keys[i] >> shift) & 0xff) + 1];
+    }
+    if (offsets[((keys[0] >> shift) & 0xff) + 1] == n) {
+      continue;
+    }
+    for (int b = 0; b < 256; ++b) {
+      offsets[b + 1] += offsets[b];
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      std::size_t dst = offsets[(keys[i] >> shift) & 0xff]++;
+      keys_tmp[dst] = keys[i];
+      items_tmp[dst] = std::move(items[i]);
+    }
+    keys.swap(keys_tmp);
+    items.swap(items_tmp);
+  }
+}
+
+// Stable sort the runs independently on a thread pool, then merge
+// adjacent runs pairwise.  std::merge takes equal elements from the
+// first run before the second, which keeps the whole sort stable.
+template <typename Key, typename T>
+void parallel_stable_sort(std::vector<std::pair<Key, T>>& items)
+{
+  auto less = [](const std::pair<Key, T>& a, const std::pair<Key, T>& b) {
+    return a.first < b.first;
+  };
+
+  const std::size_t n = items.size();
+  const std::size_t nthreads = QThread::idealThreadCount();
+  if ((n < kParallelSort) || (nthreads < 2)) {
+    std::stable_sort(items.begin(), items.end(), less);
+    return;
+  }
+
+  std::vector<std::size_t> bounds;
+  for (std::size_t i = 0; i < nthreads; ++i) {
+    bounds.push_back(n * i / nthreads);
+  }
+  bounds.push_back(n);
+
+  QThreadPool pool;
+  for (std::size_t r = 0; r + 1 < bounds.size(); ++r) {
+    auto first = items.begin() + bounds[r];
+    auto last = items.begin() + bounds[r + 1];
+    pool.start([first, last, less]() {
+      std::stable_sort(first, last, less);
+    });
+  }
+  pool.waitForDone();
+
+  std::vector<std::pair<Key, T>> merged(n);
+  while (bounds.size() > 2) {
+    std::vector<std::size_t> next_bounds;
+    std::size_t r = 0;
+    for (; r + 2 < bounds.size(); r += 2) {
+      auto first = items.begin();
+      auto dst = merged.begin();
+      const std::size_t lo = bounds[r];
+      const std::size_t mid = bounds[r + 1];
+      const std::size_t hi = bounds[r + 2];
+      pool.start([first, dst, lo, mid, hi, less]() {
+        std::merge(first + lo, first + mid, first + mid, first + hi, dst + lo, less);
+      });
+      next_bounds.push_back(lo);
+    }
+    if (r + 1 < bounds.size()) {
+      // An odd run out, carry it over to the next round unchanged.
+      std::move(items.begin() + bounds[r], items.begin() + bounds[r + 1], merged.begin() + bounds[r]);
+      next_bounds.push_back(bounds[r]);
+    }
+    next_bounds.push_back(n);
+    pool.waitForDone();
+    items.swap(merged);
+    bounds.swap(next_bounds);
+  }
+}
+
+} // namespace keysort_detail
+
+/*
+ * Stable sort [first, last) by key_of(element), ordering keys with operator<.
+ * key_of is called exactly once per element, so it should return something
+ * cheap to hold and compare, e.g. an integer or a QStringView.
+ */
+template <typename Iter, typename KeyFn>
+void stable_sort_by_key(Iter first, Iter last, KeyFn key_of)
+{
+  using T = typename std::iterator_traits<Iter>::value_type;
+  using Key = std::decay_t<std::invoke_result_t<KeyFn, const T&>>;
+
+  std::vector<std::pair<Key, T>> keyed;
+  keyed.reserve(std::distance(first, last));
+  for (auto it = first; it != last; ++it) {
+    keyed.emplace_back(key_of(*it), *it);
+  }
+  if (keyed.size() < 2) {
+    return;
+  }
+
+  if (keyed.size() < keysort_detail::kSmallSort) {
+    std::stable_sort(keyed.begin(), keyed.end(), [](const std::pair<Key, T>& a, const std::pair<Key, T>& b) {
+      return a.first < b.first;
+    });
+  } else if constexpr (std::is_integral_v<Key> && (std::is_signed_v<Key> || (sizeof(Key) < sizeof(std::int64_t)))) {
+    keysort_detail::radix_sort(keyed);
+  } else {
+    keysort_detail::parallel_stable_sort(keyed);
+  }
+
+  for (auto& [key, item] : keyed) {
+    *first++ = std::move(item);
+  }
+}
+
+} // namespace gpsbabel
+
+#endif // SRC_CORE_KEYSORT_H_
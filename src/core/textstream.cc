@@ -50,7 +50,7 @@ void TextStream::open(const QString& fname, QIODevice::OpenMode mode, const char
     auto scanfile = gpsbabel::File(fname);
     scanfile.open(mode);
     char data[4];
-    qint64 bytesread = scanfile.read(data, 4);
+    qint64 bytesread = scanfile.device()->read(data, 4);
     scanfile.close();
     encoding = QStringConverter::encodingForData(QByteArrayView(data, bytesread));
     if (encoding.has_value()) {
@@ -61,7 +61,7 @@ void TextStream::open(const QString& fname, QIODevice::OpenMode mode, const char
   if (use_stringconverter) {
     file_ = new gpsbabel::File(fname);
     file_->open(mode);
-    setDevice(file_);
+    setDevice(file_->device());
     setEncoding(encoding.value());
 
     if (mode & QFile::ReadOnly) {
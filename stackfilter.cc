@@ -35,22 +35,29 @@ void StackFilter::process()
     tmp_elt->next = stack;
     stack = tmp_elt;
 
-    waypt_list_ptr = &(tmp_elt->waypts);
-    waypt_backup(&waypt_list_ptr);
-    if (!opt_copy) {
-      waypt_flush_all();
-    }
-
-    route_list_ptr = &(tmp_elt->routes);
-    route_backup(&route_list_ptr);
-    if (!opt_copy) {
-      route_flush_all_routes();
-    }
-
-    route_list_ptr = &(tmp_elt->tracks);
-    track_backup(&route_list_ptr);
-    if (!opt_copy) {
-      route_flush_all_tracks();
+    if (opt_copy) {
+      /*
+       * This still deep copies every waypoint and route head.  Filters
+       * and formats modify waypoints in place through raw pointers, so
+       * the stack can't share them with the current data.
+       */
+      waypt_list_ptr = &(tmp_elt->waypts);
+      waypt_backup(&waypt_list_ptr);
+
+      route_list_ptr = &(tmp_elt->routes);
+      route_backup(&route_list_ptr);
+
+      route_list_ptr = &(tmp_elt->tracks);
+      track_backup(&route_list_ptr);
+    } else {
+      /*
+       * The new element is empty, so swapping hands the current data
+       * to the stack and leaves the globals empty without copying
+       * every waypoint and then deleting the originals.
+       */
+      waypt_swap(tmp_elt->waypts);
+      route_swap(tmp_elt->routes);
+      track_swap(tmp_elt->tracks);
     }
 
   } else if (opt_pop) {
@@ -59,12 +66,9 @@ void StackFilter::process()
       gbFatal("stack empty\n");
     }
     if (opt_append) {
-      waypt_append(&(stack->waypts));
-      stack->waypts.flush();
-      route_append(&(stack->routes));
-      stack->routes.flush();
-      track_append(&(stack->tracks));
-      stack->tracks.flush();
+      waypt_splice(stack->waypts);
+      route_splice(stack->routes);
+      track_splice(stack->tracks);
     } else if (opt_discard) {
       stack->waypts.flush();
       stack->routes.flush();
@@ -0,0 +1,1082 @@
+#!/usr/bin/python3
+"""
+Copyright (C) 2026 Robert Lipe, robertlipe+source@gpsbabel.org
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+"""
+
+# Simulated serial GPS devices on a pseudo-terminal.
+#
+# The simulator owns the master side of a pty and answers like the real
+# device would.  Point gpsbabel at the slave side, or at the --link
+# symlink, as if it were a serial port:
+#
+#   tools/devsim.py --link /tmp/gps skytraq --points 100000 &
+#   gpsbabel -t -i skytraq -f /tmp/gps -o gpx -F out.gpx
+#
+# Output is paced at the device's line speed, so transfer times are
+# comparable to real hardware; --no-throttle runs as fast as the pty
+# allows.  Latency, dropped and corrupted replies can be injected to
+# exercise timeouts and retries.  Transfer statistics are printed to
+# stderr when the simulator is terminated.
+#
+# Devices:
+#   skytraq    SkyTraq Venus loggers, serving a sector image or a synthesized log
+#   mtk        MTK loggers (PMTK182), serving a flash image
+#   garmin     Garmin serial (L001/A010), synthesized or previously uploaded data
+#   globalsat  Globalsat GH-625XT, replaying a dump-file recording
+#   dg100      GlobalSat DG-100/DG-200, replaying a dg-100-bin recording
+#   replay     any device, replaying a transcript made with --record
+#   proxy      forward to a real device, usually with --record
+
+import argparse
+import errno
+import json
+import math
+import os
+import select
+import signal
+import struct
+import sys
+import termios
+import time
+import tty
+from typing import Dict, List, Optional, TextIO, Tuple
+
+BAUD_RATES = [4800, 9600, 19200, 38400, 57600, 115200, 230400]
+# termios speed constant -> bits per second
+SPEEDS: Dict[int, int] = {
+    getattr(termios, "B" + str(b)): b for b in BAUD_RATES if hasattr(termios, "B" + str(b))
+}
+
+# Give up on a frame if the host pauses this long in the middle of it.
+FRAME_TIMEOUT = 1.0
+
+GarminPacket = Tuple[int, bytes]
+
+
+class Timeout(Exception):
+    pass
+
+
+class Port:
+    """The device end of a pseudo-terminal."""
+
+    def __init__(self, args: argparse.Namespace, baud: int) -> None:
+        self.master, self.slave = os.openpty()
+        # We keep the slave open so the pty survives the host closing and
+        # reopening it, as gpsbabel does between protocol phases.
+        tty.setraw(self.slave)
+        os.set_blocking(self.master, False)
+        self.name = os.ttyname(self.slave)
+        self.link: Optional[str] = args.link
+        if self.link:
+            if os.path.islink(self.link):
+                os.unlink(self.link)
+            os.symlink(self.name, self.link)
+
+        self.baud = args.baud or baud
+        self.throttle = not args.no_throttle
+        self.strict_baud = args.strict_baud
+        self.latency = args.latency / 1000.0
+        self.drop = args.drop
+        self.corrupt = args.corrupt
+        self.verbose = args.verbose
+        self.record: Optional[TextIO] = open(args.record, "w") if args.record else None
+        self.stats_file: Optional[str] = args.stats
+
+        self.rxbuf = bytearray()
+        self.tx_ready = 0.0
+        self.start = time.monotonic()
+        self.first_rx: Optional[float] = None
+        self.last_tx: Optional[float] = None
+        self.bytes_rx = 0
+        self.bytes_tx = 0
+        self.requests = 0
+        self.replies = 0
+        self.dropped = 0
+        self.corrupted = 0
+
+    def close(self) -> None:
+        if self.link and os.path.islink(self.link):
+            os.unlink(self.link)
+        if self.record:
+            self.record.close()
+        os.close(self.master)
+        os.close(self.slave)
+
+    def log(self, msg: str) -> None:
+        if self.verbose:
+            print("devsim: " + msg, file=sys.stderr, flush=True)
+
+    def trace(self, direction: str, data: bytes) -> None:
+        if self.record:
+            self.record.write("%s %.6f %s\n" % (direction, time.monotonic() - self.start, data.hex()))
+        if self.verbose > 1:
+            print("devsim: %s %s" % (direction, data.hex(" ")), file=sys.stderr, flush=True)
+
+    def host_baud(self) -> int:
+        """The line speed the host has configured on its side."""
+        return SPEEDS.get(termios.tcgetattr(self.slave)[5], 0)
+
+    def set_baud(self, baud: int) -> None:
+        self.log("line speed %d" % baud)
+        self.baud = baud
+
+    # Input.
+
+    def _fill(self, timeout: Optional[float]) -> bool:
+        r, _, _ = select.select([self.master], [], [], timeout)
+        if not r:
+            return False
+        try:
+            data = os.read(self.master, 65536)
+        except BlockingIOError:
+            return True
+        if not data:
+            return True
+        if self.strict_baud and self.baud and self.host_baud() != self.baud:
+            # At the wrong speed the device's UART sees nothing but framing errors.
+            self.log("ignoring %d bytes sent at %d baud" % (len(data), self.host_baud()))
+            return True
+        if self.first_rx is None:
+            self.first_rx = time.monotonic()
+        self.bytes_rx += len(data)
+        self.trace(">", data)
+        self.rxbuf += data
+        return True
+
+    def read(self, n: int, timeout: Optional[float] = None) -> bytes:
+        """Return exactly n bytes, waiting at most timeout seconds for each of them."""
+        while len(self.rxbuf) < n:
+            if not self._fill(timeout):
+                raise Timeout()
+        data = bytes(self.rxbuf[:n])
+        del self.rxbuf[:n]
+        return data
+
+    def read_byte(self, timeout: Optional[float] = None) -> int:
+        return self.read(1, timeout)[0]
+
+    def read_line(self, timeout: Optional[float] = None) -> bytes:
+        while True:
+            eol = self.rxbuf.find(b"\n")
+            if eol >= 0:
+                return self.read(eol + 1)
+            if not self._fill(timeout):
+                raise Timeout()
+
+    def sync(self, start: bytes) -> None:
+        """Discard input up to and including the frame start sequence."""
+        state = 0
+        while state < len(start):
+            c = self.read_byte()
+            if c == start[state]:
+                state += 1
+            elif c == start[0]:
+                state = 1
+            else:
+                state = 0
+
+    # Output.
+
+    def reply(self, data: bytes) -> None:
+        """Send one message, subject to latency and fault injection."""
+        self.replies += 1
+        if self.latency:
+            time.sleep(self.latency)
+        if self.drop and self.replies % self.drop == 0:
+            self.log("dropping reply #%d" % self.replies)
+            self.dropped += 1
+            return
+        if self.corrupt and self.replies % self.corrupt == 0 and data:
+            self.log("corrupting reply #%d" % self.replies)
+            self.corrupted += 1
+            damaged = bytearray(data)
+            damaged[len(damaged) // 2] ^= 0x20
+            data = bytes(damaged)
+        self.write(data)
+
+    def write(self, data: bytes) -> None:
+        if not data:
+            return
+        self.trace("<", data)
+        paced = self.throttle and self.baud > 0
+        # 10 bits per byte: start, 8 data and stop bit.
+        chunk = max(1, self.baud // 100) if paced else len(data)
+        for offset in range(0, len(data), chunk):
+            piece = data[offset : offset + chunk]
+            if paced:
+                now = time.monotonic()
+                if self.tx_ready > now:
+                    time.sleep(self.tx_ready - now)
+                self.tx_ready = max(self.tx_ready, now) + len(piece) * 10.0 / self.baud
+            self.bytes_tx += len(piece)
+            if not self._write_all(piece):
+                return
+            self.last_tx = time.monotonic()
+
+    def _write_all(self, data: bytes) -> bool:
+        view = memoryview(data)
+        while view:
+            try:
+                view = view[os.write(self.master, view) :]
+            except BlockingIOError:
+                _, w, _ = select.select([], [self.master], [], 2.0)
+                if not w:
+                    # Nobody is reading, e.g. the host gave up on us.
+                    self.log("host stopped reading, discarding output")
+                    termios.tcflush(self.slave, termios.TCIFLUSH)
+                    return False
+            except OSError as e:
+                if e.errno != errno.EIO:
+                    raise
+                return False
+        return True
+
+    def report(self, device: str) -> None:
+        elapsed = 0.0
+        if self.first_rx is not None and self.last_tx is not None:
+            elapsed = max(self.last_tx - self.first_rx, 0.0)
+        stats = {
+            "device": device,
+            "bytes_rx": self.bytes_rx,
+            "bytes_tx": self.bytes_tx,
+            "requests": self.requests,
+            "replies": self.replies,
+            "dropped": self.dropped,
+            "corrupted": self.corrupted,
+            "elapsed": round(elapsed, 6),
+            "throughput": round(self.bytes_tx / elapsed) if elapsed > 0 else 0,
+        }
+        print(
+            "devsim: %s: %d requests, %d replies, %d bytes in, %d bytes out in %.3fs (%d bytes/s)"
+            % (
+                device,
+                self.requests,
+                self.replies,
+                self.bytes_rx,
+                self.bytes_tx,
+                elapsed,
+                stats["throughput"],
+            ),
+            file=sys.stderr,
+        )
+        if self.stats_file:
+            with open(self.stats_file, "w") as f:
+                json.dump(stats, f, indent=2)
+                f.write("\n")
+
+
+class Device:
+    name = "device"
+    baud = 9600
+
+    def __init__(self, args: argparse.Namespace) -> None:
+        self.args = args
+
+    def run(self, port: Port) -> None:
+        raise NotImplementedError
+
+
+def read_image(path: str, repeat: int = 1) -> bytes:
+    with open(path, "rb") as f:
+        return f.read() * repeat
+
+
+def be16(v: int) -> bytes:
+    return struct.pack(">H", v & 0xFFFF)
+
+
+def me32(v: int) -> bytes:
+    """SkyTraq's "middle-endian" 32 bit fields."""
+    v &= 0xFFFFFFFF
+    return be16(v) + be16(v >> 16)
+
+
+def ecef(lat: float, lon: float, alt: float) -> Tuple[int, int, int]:
+    a = 6378137.0
+    e2 = 6.69437999014e-3
+    phi = math.radians(lat)
+    lam = math.radians(lon)
+    n = a / math.sqrt(1 - e2 * math.sin(phi) ** 2)
+    x = (n + alt) * math.cos(phi) * math.cos(lam)
+    y = (n + alt) * math.cos(phi) * math.sin(lam)
+    z = (n * (1 - e2) + alt) * math.sin(phi)
+    return round(x), round(y), round(z)
+
+
+def synthetic_track(points: int, seconds: int = 1) -> List[Tuple[int, float, float, float]]:
+    """A wandering track of (time offset, lat, lon, alt) tuples."""
+    track = []
+    lat, lon, alt = 48.137, 11.575, 520.0
+    for i in range(points):
+        heading = math.radians((i * 0.7) % 360)
+        lat += 4e-5 * math.cos(heading)
+        lon += 6e-5 * math.sin(heading)
+        alt = 520.0 + 20.0 * math.sin(i / 50.0)
+        track.append((i * seconds, lat, lon, alt))
+    return track
+
+
+class SkyTraq(Device):
+    """SkyTraq Venus 5/6 data logger."""
+
+    name = "skytraq"
+    baud = 9600
+    SECTOR = 4096
+    END_TAG = b"END\0CHECKSUM="
+    FULL_ITEM = 18
+    COMPACT_ITEM = 8
+
+    def __init__(self, args: argparse.Namespace) -> None:
+        super().__init__(args)
+        if args.image:
+            image = read_image(args.image, args.repeat)
+        else:
+            image = self.synthesize(args.points)
+        self.used = (len(image.rstrip(b"\xff")) + self.SECTOR - 1) // self.SECTOR
+        self.flash = bytearray(image[: self.used * self.SECTOR])
+        self.total = max(args.sectors, self.used + 1)
+        self.flash += b"\xff" * (self.total * self.SECTOR - len(self.flash))
+        self.multi = not args.no_multi
+
+    @classmethod
+    def synthesize(cls, points: int) -> bytes:
+        """A log of full and compact items, packed into sectors like the logger does."""
+        week = 2300
+        sec = 200000
+        sectors = [bytearray()]
+        last: Optional[Tuple[int, int, int, int]] = None
+        for i, (dt, lat, lon, alt) in enumerate(synthetic_track(points)):
+            t = sec + dt
+            wk, wsec = week + t // 604800, t % 604800
+            x, y, z = ecef(lat, lon, alt)
+            speed = 18
+            item = b""
+            if last is not None and i % 100 != 0:
+                deltas = (t - last[0], x - last[1], y - last[2], z - last[3])
+                if 0 <= deltas[0] <= 0xFFFF and all(-512 <= d <= 511 for d in deltas[1:]):
+                    dx, dy, dz = (d if d >= 0 else 511 - d for d in deltas[1:])
+                    item = (
+                        bytes([0x80 | (speed >> 8), speed & 0xFF])
+                        + be16(deltas[0])
+                        + bytes(
+                            [
+                                dx >> 2,
+                                ((dx & 3) << 6) | (dy & 0x3F),
+                                ((dy >> 6) << 4) | (dz >> 8),
+                                dz & 0xFF,
+                            ]
+                        )
+                    )
+            # Each sector starts with a full item.
+            if not item or len(sectors[-1]) + len(item) >= cls.SECTOR:
+                item = (
+                    bytes([0x40 | (speed >> 8), speed & 0xFF])
+                    + me32((wsec << 12) | (wk & 0x3FF))
+                    + me32(x)
+                    + me32(y)
+                    + me32(z)
+                )
+            # Items never straddle sectors, and a sector is never filled
+            # completely, which the single sector read can't handle.
+            if len(sectors[-1]) + len(item) >= cls.SECTOR:
+                sectors.append(bytearray())
+            sectors[-1] += item
+            last = (t, x, y, z)
+        return b"".join(bytes(s) + b"\xff" * (cls.SECTOR - len(s)) for s in sectors)
+
+    @staticmethod
+    def checksum(data: bytes) -> int:
+        cs = 0
+        for c in data:
+            cs ^= c
+        return cs
+
+    def message(self, payload: bytes) -> bytes:
+        return b"\xa0\xa1" + be16(len(payload)) + payload + bytes([self.checksum(payload)]) + b"\r\n"
+
+    def ack(self, port: Port, msg_id: int) -> None:
+        port.reply(self.message(bytes([0x83, msg_id])))
+
+    def nack(self, port: Port, msg_id: int) -> None:
+        port.reply(self.message(bytes([0x84, msg_id])))
+
+    def run(self, port: Port) -> None:
+        while True:
+            port.sync(b"\xa0\xa1")
+            try:
+                (length,) = struct.unpack(">H", port.read(2, FRAME_TIMEOUT))
+                payload = port.read(length, FRAME_TIMEOUT)
+                cs = port.read_byte(FRAME_TIMEOUT)
+                port.read(2, FRAME_TIMEOUT)
+            except Timeout:
+                port.log("incomplete message")
+                continue
+            if not payload or cs != self.checksum(payload):
+                port.log("bad checksum")
+                continue
+            port.requests += 1
+            self.handle(port, payload)
+
+    def handle(self, port: Port, payload: bytes) -> None:
+        msg_id = payload[0]
+        if msg_id == 0x02:  # query software version
+            self.ack(port, msg_id)
+            port.reply(self.message(bytes([0x80, 0x01, 0, 1, 4, 19, 0, 1, 1, 19, 0, 9, 11, 3])))
+        elif msg_id == 0x05 and len(payload) >= 3:  # configure serial port
+            if payload[2] >= len(BAUD_RATES):
+                self.nack(port, msg_id)
+                return
+            self.ack(port, msg_id)
+            port.set_baud(BAUD_RATES[payload[2]])
+        elif msg_id == 0x01:  # system restart
+            self.ack(port, msg_id)
+            port.set_baud(self.args.baud or self.baud)
+        elif msg_id == 0x17:  # log status
+            self.ack(port, msg_id)
+            status = struct.pack(
+                "<BIHH6IBB",
+                0x94,
+                self.used * self.SECTOR,
+                self.total - self.used,
+                self.total,
+                3600,
+                6,
+                10000,
+                0,
+                0xFFFF,
+                0,
+                1,
+                0,
+            )
+            port.reply(self.message(status))
+        elif msg_id == 0x18:  # configure logging
+            self.ack(port, msg_id)
+        elif msg_id == 0x19:  # erase
+            self.ack(port, msg_id)
+            self.flash = bytearray(b"\xff" * len(self.flash))
+            self.used = 0
+        elif msg_id == 0x1B and len(payload) >= 2:  # read one sector
+            sector = payload[1]
+            if sector >= self.total:
+                self.nack(port, msg_id)
+                return
+            self.ack(port, msg_id)
+            data = bytes(self.flash[sector * self.SECTOR : (sector + 1) * self.SECTOR])
+            data = data.rstrip(b"\xff")
+            out = data + self.END_TAG + bytes([self.checksum(data)])
+            # The host reads in 16 byte chunks.
+            out += b"\0" * (-len(out) % 16)
+            port.reply(out)
+        elif msg_id == 0x1D and len(payload) >= 5:  # read multiple sectors
+            first, count = struct.unpack(">HH", payload[1:5])
+            if not self.multi or first + count > self.total:
+                self.nack(port, msg_id)
+                return
+            self.ack(port, msg_id)
+            data = bytes(self.flash[first * self.SECTOR : (first + count) * self.SECTOR])
+            port.reply(data + self.END_TAG + bytes([self.checksum(data)]) + b"\0" * 5)
+        elif msg_id in (0x35, 0x36):  # location finder
+            self.ack(port, msg_id)
+            if msg_id == 0x35:
+                port.reply(self.message(bytes([0xB5]) + bytes(16)))
+        else:
+            self.nack(port, msg_id)
+
+
+class Mtk(Device):
+    """MTK based logger, e.g. Transystem i-Blue 747 or Holux M-241."""
+
+    name = "mtk"
+    baud = 115200
+    CHUNK = 0x800
+
+    def __init__(self, args: argparse.Namespace) -> None:
+        super().__init__(args)
+        self.flash = read_image(args.image, args.repeat)
+        self.model: str = args.model
+        self.logging = True
+        if "M-241" in self.model or "GR-245" in self.model:
+            self.baud = 38400
+
+    @staticmethod
+    def sentence(body: str) -> bytes:
+        cs = 0
+        for c in body.encode():
+            cs ^= c
+        return ("$%s*%02X\r\n" % (body, cs)).encode()
+
+    def run(self, port: Port) -> None:
+        while True:
+            line = port.read_line().strip()
+            if not line.startswith(b"$"):
+                continue
+            port.requests += 1
+            body = line[1:].split(b"*")[0].decode("ascii", "replace")
+            self.handle(port, body.split(","))
+
+    def flash_read(self, addr: int, size: int) -> bytes:
+        data = self.flash[addr : addr + size]
+        return data + b"\xff" * (size - len(data))
+
+    def handle(self, port: Port, f: List[str]) -> None:
+        if f[0] == "PMTK605":
+            port.reply(self.sentence("PMTK705," + self.model))
+        elif f[0] == "PHLX810":
+            port.reply(self.sentence("PHLX852,GR245"))
+        elif f[0] == "PHLX826":
+            port.reply(self.sentence("PHLX859"))
+        elif f[0] == "PHLX827":
+            port.reply(self.sentence("PHLX860"))
+        elif f[0] == "PMTK182" and len(f) >= 2:
+            self.log_command(port, f)
+        else:
+            port.reply(self.sentence("PMTK001,%s,1" % f[0][4:]))
+
+    def log_command(self, port: Port, f: List[str]) -> None:
+        cmd = f[1]
+        if cmd == "2" and len(f) >= 3:  # query
+            if f[2] == "2":
+                mask = struct.unpack("<I", self.flash_read(2, 4))[0]
+                port.reply(self.sentence("PMTK182,3,2,%08X" % mask))
+            elif f[2] == "7":
+                port.reply(self.sentence("PMTK182,3,7,%d" % (2 if self.logging else 0)))
+            elif f[2] == "8":
+                port.reply(self.sentence("PMTK182,3,8,%08X" % len(self.flash)))
+            else:
+                port.reply(self.sentence("PMTK001,182,2,1"))
+        elif cmd == "4":
+            self.logging = True
+            port.reply(self.sentence("PMTK001,182,4,3"))
+        elif cmd == "5":
+            self.logging = False
+            port.reply(self.sentence("PMTK001,182,5,3"))
+        elif cmd == "6":
+            self.flash = b""
+            port.reply(self.sentence("PMTK001,182,6,3"))
+        elif cmd == "7" and len(f) >= 4:  # read memory
+            addr = int(f[2], 16)
+            size = int(f[3], 16)
+            for offset in range(0, size, self.CHUNK):
+                n = min(self.CHUNK, size - offset)
+                data = self.flash_read(addr + offset, n)
+                port.reply(
+                    self.sentence("PMTK182,8,%08X,%s" % (addr + offset, data.hex().upper()))
+                )
+            port.reply(self.sentence("PMTK001,182,7,3"))
+        else:
+            port.reply(self.sentence("PMTK001,182,%s,1" % cmd))
+
+
+class Garmin(Device):
+    """Garmin serial protocol: L001 link, A010 commands, D108/D202/D210/D310/D301 data."""
+
+    name = "garmin"
+    baud = 9600
+    DLE = 0x10
+    ETX = 0x03
+    ACK = 6
+    NAK = 21
+    XFER_CMPLT = 12
+    RECORDS = 27
+    RTE_HDR = 29
+    RTE_WPT = 30
+    TRK_DATA = 34
+    WPT_DATA = 35
+    RTE_LINK = 98
+    TRK_HDR = 99
+    PROTOCOL_ARRAY = 253
+    PRODUCT_RQST = 254
+    PRODUCT_DATA = 255
+    CMND_DATA = 10
+    CMD_RTE = 4
+    CMD_TRK = 6
+    CMD_WPT = 7
+    GARMIN_EPOCH = 631065600
+    PROTOCOLS = [
+        ("P", 0),
+        ("L", 1),
+        ("A", 10),
+        ("A", 100),
+        ("D", 108),
+        ("A", 201),
+        ("D", 202),
+        ("D", 108),
+        ("D", 210),
+        ("A", 301),
+        ("D", 310),
+        ("D", 301),
+    ]
+
+    def __init__(self, args: argparse.Namespace) -> None:
+        super().__init__(args)
+        self.data: Dict[int, List[GarminPacket]] = {
+            self.CMD_WPT: self.make_waypoints(args.waypoints),
+            self.CMD_TRK: self.make_tracks(args.tracks, args.points),
+            self.CMD_RTE: self.make_routes(args.routes, args.route_points),
+        }
+        for cmd, packets in self.data.items():
+            if len(packets) > 0xFFFF:
+                raise SystemExit("devsim: too many records for one transfer (%d)" % len(packets))
+        self.upload: Optional[List[GarminPacket]] = None
+
+    @staticmethod
+    def semicircles(deg: float) -> int:
+        return int(round(deg * 2**31 / 180.0))
+
+    @classmethod
+    def d108(cls, ident: str, lat: float, lon: float, alt: float) -> bytes:
+        return (
+            struct.pack(
+                "<BBBBH18siifff2s2s",
+                0,
+                0xFF,
+                0,
+                0x60,
+                18,
+                b"\0" * 6 + b"\xff" * 12,
+                cls.semicircles(lat),
+                cls.semicircles(lon),
+                alt,
+                1.0e25,
+                1.0e25,
+                b"  ",
+                b"  ",
+            )
+            + ident.encode()
+            + b"\0"
+            + ("Simulated " + ident).encode()
+            + b"\0" * 5
+        )
+
+    def make_waypoints(self, count: int) -> List[GarminPacket]:
+        return [
+            (self.WPT_DATA, self.d108("WPT%05d" % i, lat, lon, alt))
+            for i, (_, lat, lon, alt) in enumerate(synthetic_track(count, 60))
+        ]
+
+    def make_tracks(self, tracks: int, points: int) -> List[GarminPacket]:
+        packets: List[GarminPacket] = []
+        t0 = 1000000000 - self.GARMIN_EPOCH
+        for trk in range(tracks):
+            packets.append((self.TRK_HDR, struct.pack("<BB", 1, 0xFF) + b"TRACK%03d\0" % trk))
+            for i, (dt, lat, lon, alt) in enumerate(synthetic_track(points)):
+                packets.append(
+                    (
+                        self.TRK_DATA,
+                        struct.pack(
+                            "<iiIffB",
+                            self.semicircles(lat + trk * 0.01),
+                            self.semicircles(lon),
+                            t0 + trk * 86400 + dt,
+                            alt,
+                            1.0e25,
+                            1 if i == 0 else 0,
+                        ),
+                    )
+                )
+        return packets
+
+    def make_routes(self, routes: int, points: int) -> List[GarminPacket]:
+        packets: List[GarminPacket] = []
+        link = struct.pack("<H18s", 0, b"\0" * 6 + b"\xff" * 12) + b"\0"
+        for rte in range(routes):
+            packets.append((self.RTE_HDR, b"ROUTE%03d\0" % rte))
+            for i, (_, lat, lon, alt) in enumerate(synthetic_track(points, 60)):
+                if i > 0:
+                    packets.append((self.RTE_LINK, link))
+                packets.append(
+                    (self.RTE_WPT, self.d108("R%03dP%03d" % (rte, i), lat + rte * 0.01, lon, alt))
+                )
+        return packets
+
+    def packet(self, pid: int, data: bytes) -> bytes:
+        body = bytes([len(data)]) + data
+        body += bytes([-(pid + sum(body)) & 0xFF])
+        return (
+            bytes([self.DLE, pid])
+            + body.replace(bytes([self.DLE]), bytes([self.DLE, self.DLE]))
+            + bytes([self.DLE, self.ETX])
+        )
+
+    def read_packet(self, port: Port, timeout: Optional[float] = None) -> GarminPacket:
+        while True:
+            if port.read_byte(timeout) != self.DLE:
+                continue
+            pid = port.read_byte(FRAME_TIMEOUT)
+            if pid in (self.DLE, self.ETX):
+                continue
+            body = bytearray()
+            while True:
+                c = port.read_byte(FRAME_TIMEOUT)
+                if c == self.DLE:
+                    c = port.read_byte(FRAME_TIMEOUT)
+                    if c == self.ETX:
+                        break
+                body.append(c)
+            if len(body) < 2 or body[0] != len(body) - 2 or (pid + sum(body)) & 0xFF:
+                port.log("bad packet %d" % pid)
+                port.write(self.packet(self.NAK, bytes([pid, 0])))
+                continue
+            return pid, bytes(body[1:-1])
+
+    def send(self, port: Port, pid: int, data: bytes) -> bool:
+        """Send one packet and wait for the host to acknowledge it."""
+        for _ in range(3):
+            port.reply(self.packet(pid, data))
+            try:
+                while True:
+                    rpid, rdata = self.read_packet(port, 2.0)
+                    if rpid == self.ACK and rdata[:1] == bytes([pid]):
+                        return True
+                    if rpid == self.NAK:
+                        break
+            except Timeout:
+                port.log("no ACK for packet %d" % pid)
+        return False
+
+    def transfer(self, port: Port, cmd: int, packets: List[GarminPacket]) -> None:
+        if not self.send(port, self.RECORDS, struct.pack("<H", len(packets))):
+            return
+        for pid, data in packets:
+            if not self.send(port, pid, data):
+                return
+        self.send(port, self.XFER_CMPLT, struct.pack("<H", cmd))
+
+    def run(self, port: Port) -> None:
+        while True:
+            try:
+                pid, data = self.read_packet(port)
+            except Timeout:
+                continue
+            if pid in (self.ACK, self.NAK):
+                continue
+            port.requests += 1
+            port.write(self.packet(self.ACK, bytes([pid, 0])))
+            self.handle(port, pid, data)
+
+    def handle(self, port: Port, pid: int, data: bytes) -> None:
+        if pid == self.PRODUCT_RQST:
+            product = struct.pack("<hh", 291, 400) + b"GPSMAP 60CS Software Version 4.00\0"
+            if self.send(port, self.PRODUCT_DATA, product):
+                protocols = b"".join(
+                    tag.encode() + struct.pack("<H", n) for tag, n in self.PROTOCOLS
+                )
+                self.send(port, self.PROTOCOL_ARRAY, protocols)
+        elif pid == self.CMND_DATA and len(data) >= 2:
+            (cmd,) = struct.unpack("<H", data[:2])
+            if cmd in self.data:
+                self.transfer(port, cmd, self.data[cmd])
+        elif pid == self.RECORDS:
+            self.upload = []
+        elif pid == self.XFER_CMPLT and len(data) >= 2:
+            (cmd,) = struct.unpack("<H", data[:2])
+            if self.upload is not None and cmd in self.data:
+                port.log("stored %d uploaded records for command %d" % (len(self.upload), cmd))
+                self.data[cmd] = self.upload
+            self.upload = None
+        elif pid == 0x30 and len(data) >= 4:  # baud rate change request
+            (baud,) = struct.unpack("<I", data[:4])
+            if self.send(port, 0x31, struct.pack("<I", baud)):
+                port.set_baud(baud)
+        elif self.upload is not None:
+            self.upload.append((pid, data))
+
+
+class GlobalsatReplay(Device):
+    """Globalsat GH-625XT, answering each request with the next reply of a dump-file."""
+
+    name = "globalsat"
+    baud = 115200
+
+    def __init__(self, args: argparse.Namespace) -> None:
+        super().__init__(args)
+        dump = read_image(args.replay)
+        self.replies: List[bytes] = []
+        pos = 0
+        while pos + 4 <= len(dump):
+            (length,) = struct.unpack(">H", dump[pos + 1 : pos + 3])
+            self.replies.append(dump[pos : pos + 4 + length])
+            pos += 4 + length
+        self.next = 0
+
+    def run(self, port: Port) -> None:
+        while True:
+            port.sync(b"\x02")
+            try:
+                header = port.read(2, FRAME_TIMEOUT)
+                (length,) = struct.unpack(">H", header)
+                payload = port.read(length, FRAME_TIMEOUT)
+                crc = port.read_byte(FRAME_TIMEOUT)
+            except Timeout:
+                port.log("incomplete request")
+                continue
+            calc = 0
+            for c in header + payload:
+                calc ^= c
+            if crc != calc:
+                port.log("bad checksum")
+                continue
+            port.requests += 1
+            if self.next >= len(self.replies):
+                port.log("recording exhausted, ignoring command 0x%02x" % payload[0])
+                continue
+            port.reply(self.replies[self.next])
+            self.next += 1
+
+
+class Dg100Replay(Device):
+    """GlobalSat DG-100/DG-200, replaying the dialog recorded in a dg-100-bin file."""
+
+    name = "dg100"
+    baud = 115200
+    # answer id -> (param length, trailing bytes)
+    ANSWERS = {
+        0xB5: (1024, 2),  # getfile
+        0xBB: (-1, 2),  # getfileheader
+        0xBA: (4, 2),  # erase
+        0xB7: (44, 2),  # getconfig
+        0xB8: (4, 2),  # setconfig
+        0xBF: (8, 2),  # getid
+        0xC0: (4, 2),  # setid
+        0xBC: (0, 0),  # gpsmouse
+        0x80: (0, 0),  # reset
+    }
+
+    def __init__(self, args: argparse.Namespace) -> None:
+        super().__init__(args)
+        self.dg200 = args.model == "dg200"
+        if self.dg200:
+            self.baud = 230400
+        self.dialog = self.parse(read_image(args.replay))
+        self.next = 0
+
+    def answer_len(self, rec: bytes, pos: int) -> int:
+        (payload_len,) = struct.unpack(">H", rec[pos + 2 : pos + 4])
+        cmd = rec[pos + 4]
+        # getconfig and setconfig answer with the same id.
+        if cmd == 0xB7 and payload_len <= 20:
+            cmd = 0xB8
+        param_len, trailing = self.ANSWERS[cmd]
+        if cmd == 0xB7 and self.dg200:
+            param_len = 45
+        if cmd == 0xBB:
+            (numheaders,) = struct.unpack(">H", rec[pos + 5 : pos + 7])
+            param_len = 2 + 2 + 12 * numheaders
+        if not self.dg200:
+            param_len += trailing
+        return 2 + 2 + 1 + param_len + (0 if self.dg200 else 2) + 2 + 2
+
+    def parse(self, rec: bytes) -> List[Tuple[bytes, bytes]]:
+        dialog = []
+        pos = 0
+        while pos + 5 <= len(rec):
+            (payload_len,) = struct.unpack(">H", rec[pos + 2 : pos + 4])
+            request = rec[pos : pos + 2 + 2 + payload_len + 2 + 2]
+            cmd = request[4]
+            pos += len(request)
+            frames = {0xB5: 2, 0xBC: 0, 0x80: 0}.get(cmd, 1)
+            start = pos
+            for _ in range(frames):
+                pos += self.answer_len(rec, pos)
+            dialog.append((request, rec[start:pos]))
+        return dialog
+
+    def run(self, port: Port) -> None:
+        while True:
+            port.sync(b"\xa0\xa2")
+            try:
+                (payload_len,) = struct.unpack(">H", port.read(2, FRAME_TIMEOUT))
+                request = b"\xa0\xa2" + be16(payload_len) + port.read(payload_len + 4, FRAME_TIMEOUT)
+            except Timeout:
+                port.log("incomplete request")
+                continue
+            port.requests += 1
+            # Allow the host to skip or repeat requests.
+            for i in list(range(self.next, len(self.dialog))) + list(range(self.next)):
+                if self.dialog[i][0] == request:
+                    port.reply(self.dialog[i][1])
+                    self.next = i + 1
+                    break
+            else:
+                port.log("request %s is not in the recording" % request.hex())
+
+
+class Replay(Device):
+    """Replay a transcript recorded with --record."""
+
+    name = "replay"
+
+    def __init__(self, args: argparse.Namespace) -> None:
+        super().__init__(args)
+        self.baud = args.baud or 9600
+        # Alternating blocks of host and device bytes.
+        self.blocks: List[Tuple[str, bytearray]] = []
+        with open(args.transcript) as f:
+            for line in f:
+                fields = line.split()
+                if len(fields) != 3 or fields[0] not in "<>":
+                    continue
+                if not self.blocks or self.blocks[-1][0] != fields[0]:
+                    self.blocks.append((fields[0], bytearray()))
+                self.blocks[-1][1].extend(bytes.fromhex(fields[2]))
+
+    def run(self, port: Port) -> None:
+        for direction, data in self.blocks:
+            if direction == "<":
+                port.reply(bytes(data))
+                continue
+            got = port.read(len(data))
+            port.requests += 1
+            if got != data:
+                port.log("host diverged from the transcript")
+        port.log("end of transcript")
+        while True:
+            port.read(1)
+
+
+class Proxy(Device):
+    """Pass everything through to a real device, for use with --record."""
+
+    name = "proxy"
+
+    def __init__(self, args: argparse.Namespace) -> None:
+        super().__init__(args)
+        self.device = os.open(args.device, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+        tty.setraw(self.device)
+        self.speed = 0
+
+    def run(self, port: Port) -> None:
+        port.throttle = False
+        while True:
+            r, _, _ = select.select([port.master, self.device], [], [])
+            # Follow the host's line settings.
+            attrs = termios.tcgetattr(port.slave)
+            if attrs[5] != self.speed:
+                self.speed = attrs[5]
+                dev = termios.tcgetattr(self.device)
+                dev[4] = dev[5] = self.speed
+                termios.tcsetattr(self.device, termios.TCSADRAIN, dev)
+                port.log("line speed %d" % SPEEDS.get(self.speed, 0))
+            if port.master in r and port._fill(0):
+                data = bytes(port.rxbuf)
+                port.rxbuf.clear()
+                port.requests += 1
+                os.write(self.device, data)
+            if self.device in r:
+                try:
+                    data = os.read(self.device, 65536)
+                except BlockingIOError:
+                    continue
+                port.replies += 1
+                port.write(data)
+
+
+DEVICES = {
+    "skytraq": SkyTraq,
+    "mtk": Mtk,
+    "garmin": Garmin,
+    "globalsat": GlobalsatReplay,
+    "dg100": Dg100Replay,
+    "replay": Replay,
+    "proxy": Proxy,
+}
+
+
+def parse_args(argv: List[str]) -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description="Simulate serial GPS devices on a pseudo-terminal.")
+    parser.add_argument("--link", help="create a symlink to the pty with this name")
+    parser.add_argument(
+        "--baud", type=int, default=0, help="initial line speed (default: that of the device)"
+    )
+    parser.add_argument(
+        "--no-throttle", action="store_true", help="don't pace output at the line speed"
+    )
+    parser.add_argument(
+        "--strict-baud",
+        action="store_true",
+        help="ignore input unless the host's line speed matches the device's",
+    )
+    parser.add_argument("--latency", type=float, default=0, help="delay each reply (ms)")
+    parser.add_argument("--drop", type=int, default=0, metavar="N", help="drop every Nth reply")
+    parser.add_argument(
+        "--corrupt", type=int, default=0, metavar="N", help="damage one byte of every Nth reply"
+    )
+    parser.add_argument("--record", metavar="FILE", help="write a transcript of the session")
+    parser.add_argument("--stats", metavar="FILE", help="write transfer statistics as JSON")
+    parser.add_argument("-v", "--verbose", action="count", default=0, help="log events (twice: data)")
+    sub = parser.add_subparsers(dest="device", required=True)
+
+    p = sub.add_parser("skytraq", help="SkyTraq Venus data logger")
+    source = p.add_mutually_exclusive_group(required=True)
+    source.add_argument("--image", help="sector image, e.g. a skytraq-bin file")
+    source.add_argument("--points", type=int, help="synthesize a log with this many points")
+    p.add_argument("--repeat", type=int, default=1, help="repeat the image N times")
+    p.add_argument("--sectors", type=int, default=256, help="total sectors of the flash")
+    p.add_argument("--no-multi", action="store_true", help="reject multi-sector reads")
+
+    p = sub.add_parser("mtk", help="MTK based logger")
+    p.add_argument("--image", required=True, help="flash image, e.g. an mtk-bin file")
+    p.add_argument("--repeat", type=int, default=1, help="repeat the image N times")
+    p.add_argument("--model", default="AXN_0.3_2025_3100_1111,0001,MTK,1.0", help="PMTK705 reply")
+
+    p = sub.add_parser("garmin", help="Garmin serial protocol")
+    p.add_argument("--waypoints", type=int, default=100)
+    p.add_argument("--tracks", type=int, default=1)
+    p.add_argument("--points", type=int, default=1000, help="points per track")
+    p.add_argument("--routes", type=int, default=1)
+    p.add_argument("--route-points", type=int, default=20, help="points per route")
+
+    p = sub.add_parser("globalsat", help="Globalsat GH-625XT")
+    p.add_argument("--replay", required=True, help="file written with dump-file")
+
+    p = sub.add_parser("dg100", help="GlobalSat DG-100/DG-200")
+    p.add_argument("--replay", required=True, help="dialog recorded as a dg-100-bin file")
+    p.add_argument("--model", choices=["dg100", "dg200"], default="dg100")
+
+    p = sub.add_parser("replay", help="replay a transcript")
+    p.add_argument("transcript", help="file written with --record")
+
+    p = sub.add_parser("proxy", help="pass through to a real device")
+    p.add_argument("device", help="serial port of the device")
+
+    return parser.parse_args(argv)
+
+
+def main(argv: List[str]) -> int:
+    args = parse_args(argv)
+    device = DEVICES[args.device](args)
+    port = Port(args, device.baud)
+
+    def terminate(signum: int, frame: object) -> None:
+        raise SystemExit(0)
+
+    signal.signal(signal.SIGTERM, terminate)
+    signal.signal(signal.SIGHUP, terminate)
+    print(port.name, flush=True)
+    try:
+        device.run(port)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        port.report(device.name)
+        port.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
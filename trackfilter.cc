@@ -22,13 +22,17 @@
 
 static constexpr bool TRACKF_DBG = false;
 
-#include <algorithm>                       // for_each, sort, stable_sort
+#include <algorithm>                       // for_each, sort, stable_sort, lower_bound, upper_bound
 #include <cassert>                         // for assert
 #include <cmath>                           // for nan
+#include <cstddef>                         // for size_t
 #include <cstdlib>                         // for abs
 #include <ctime>                           // for gmtime, strftime, time_t, tm
+#include <functional>                      // for greater
 #include <iterator>                        // for next
-#include <utility>                         // for as_const
+#include <queue>                           // for priority_queue
+#include <utility>                         // for as_const, pair
+#include <vector>                          // for vector
 
 #include <QByteArray>                      // for QByteArray
 #include <QChar>                           // for QChar
@@ -128,11 +132,6 @@ bool TrackFilter::trackfilter_init_sort_cb(const route_head* ha, const route_hea
   return trackfilter_get_first_time(ha) < trackfilter_get_first_time(hb);
 }
 
-bool TrackFilter::trackfilter_merge_sort_cb(const Waypoint* wa, const Waypoint* wb)
-{
-  return wa->GetCreationTime() < wb->GetCreationTime();
-}
-
 fix_type TrackFilter::trackfilter_parse_fix(int* nsats)
 {
   if (!opt_fix) {
@@ -358,26 +357,45 @@ void TrackFilter::trackfilter_merge()
 
     int original_waypt_count = track_waypt_count();
 
-    QList<Waypoint*> buff;
+    // One run of timed points per track.  Stable sorting each run and
+    // then merging the runs, taking equal times from the earlier track
+    // first, orders the points exactly like a stable sort of all of them
+    // would.  Tracks are usually sorted already, leaving just the merge.
+    using TimedWpt = std::pair<qint64, Waypoint*>;
+    std::vector<std::vector<TimedWpt>> runs;
+    qsizetype total = 0;
 
     auto it = track_list.cbegin();
-    while (it != track_list.cend()) { /* put all points into temp buffer */
+    while (it != track_list.cend()) { /* put all points into runs */
       route_head* track = *it;
       // steal all the wpts
       WaypointList wpts;
       track_swap_wpts(track, wpts);
-      // add them to the buff or delete them
-      foreach (Waypoint* wpt, wpts) {
+      // add them to the run or delete them
+      std::vector<TimedWpt>& run = runs.emplace_back();
+      run.reserve(wpts.count());
+      bool sorted = true;
+      for (Waypoint* wpt : std::as_const(wpts)) {
         if (wpt->creation_time.isValid()) {
           // we will put the merged points in one track segment,
           // as it isn't clear how track segments in the original tracks
           // should relate to the merged track.
           wpt->wpt_flags.new_trkseg = 0;
-          buff.append(wpt);
+          const qint64 msecs = wpt->creation_time.toMSecsSinceEpoch();
+          if (!run.empty() && (msecs < run.back().first)) {
+            sorted = false;
+          }
+          run.emplace_back(msecs, wpt);
         } else {
           delete wpt;
         }
       }
+      if (!sorted) {
+        std::stable_sort(run.begin(), run.end(), [](const TimedWpt& a, const TimedWpt& b) {
+          return a.first < b.first;
+        });
+      }
+      total += run.size();
       if (it != track_list.cbegin()) {
         track_del_head(track);
         it = static_cast<RouteList::const_iterator>(track_list.erase(it));
@@ -386,18 +404,35 @@ void TrackFilter::trackfilter_merge()
       }
     }
 
-    std::stable_sort(buff.begin(), buff.end(), trackfilter_merge_sort_cb);
+    // k-way merge of the runs, dropping points with duplicate times.
+    using RunHead = std::pair<qint64, std::size_t>; /* time, run */
+    std::priority_queue<RunHead, std::vector<RunHead>, std::greater<>> heads;
+    std::vector<std::size_t> next(runs.size(), 0);
+    for (std::size_t r = 0; r < runs.size(); ++r) {
+      if (!runs[r].empty()) {
+        heads.emplace(runs[r].front().first, r);
+      }
+    }
 
-    const Waypoint* prev = nullptr;
+    QList<Waypoint*> buff;
+    buff.reserve(total);
+    qint64 prev_msecs = 0;
+    while (!heads.empty()) {
+      const auto [msecs, r] = heads.top();
+      heads.pop();
+      Waypoint* wpt = runs[r][next[r]].second;
+      if (++next[r] < runs[r].size()) {
+        heads.emplace(runs[r][next[r]].first, r);
+      }
 
-    for (auto* wpt : buff) {
-      if ((prev == nullptr) || (prev->GetCreationTime() != wpt->GetCreationTime())) {
-        track_add_wpt(master, wpt);
-        prev = wpt;
+      if (buff.isEmpty() || (prev_msecs != msecs)) {
+        buff.append(wpt);
+        prev_msecs = msecs;
       } else {
         delete wpt;
       }
     }
+    track_add_wpts(master, buff);
 
     if (master->rte_waypt_empty()) {
       track_del_head(master);
@@ -713,20 +748,58 @@ void TrackFilter::trackfilter_range()
   while (it != track_list.cend()) {
     route_head* track = *it;
 
-    foreach (Waypoint* wpt, track->waypoint_list) {
-      bool inside;
-      if (wpt->creation_time.isValid()) {
-        bool after_start = !start.isValid() || (wpt->GetCreationTime() >= start);
-        bool before_stop = !stop.isValid() || (wpt->GetCreationTime() <= stop);
-        inside = after_start && before_stop;
-      } else {
-        // If the time is mangled so horribly that it's
-        // negative, toss it.
-        inside = false;
+    // Time ordered tracks (the usual case) are cut with a binary search,
+    // and left alone if nothing falls outside of the range.
+    std::vector<qint64> times;
+    times.reserve(track->rte_waypt_ct());
+    bool sorted = true;
+    for (const Waypoint* wpt : std::as_const(track->waypoint_list)) {
+      if (!wpt->creation_time.isValid()) {
+        sorted = false;
+        break;
+      }
+      const qint64 msecs = wpt->creation_time.toMSecsSinceEpoch();
+      if (!times.empty() && (msecs < times.back())) {
+        sorted = false;
+        break;
+      }
+      times.push_back(msecs);
+    }
+
+    if (sorted) {
+      const auto first = start.isValid() ?
+                         std::lower_bound(times.cbegin(), times.cend(), start.toMSecsSinceEpoch()) : times.cbegin();
+      const auto last = stop.isValid() ?
+                        std::upper_bound(first, times.cend(), stop.toMSecsSinceEpoch()) : times.cend();
+      if (!times.empty() && (first == times.cbegin()) && (last == times.cend())) {
+        ++it;
+        continue;
       }
+      const qsizetype keep_begin = first - times.cbegin();
+      const qsizetype keep_end = last - times.cbegin();
+      qsizetype idx = 0;
+      for (Waypoint* wpt : std::as_const(track->waypoint_list)) {
+        if ((idx < keep_begin) || (idx >= keep_end)) {
+          wpt->wpt_flags.marked_for_deletion = 1;
+        }
+        ++idx;
+      }
+    } else {
+      foreach (Waypoint* wpt, track->waypoint_list) {
+        bool inside;
+        if (wpt->creation_time.isValid()) {
+          bool after_start = !start.isValid() || (wpt->GetCreationTime() >= start);
+          bool before_stop = !stop.isValid() || (wpt->GetCreationTime() <= stop);
+          inside = after_start && before_stop;
+        } else {
+          // If the time is mangled so horribly that it's
+          // negative, toss it.
+          inside = false;
+        }
 
-      if (!inside) {
-        wpt->wpt_flags.marked_for_deletion = 1;
+        if (!inside) {
+          wpt->wpt_flags.marked_for_deletion = 1;
+        }
       }
     }
     // delete marked wpts
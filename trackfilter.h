@@ -65,7 +65,6 @@ private:
   int trackfilter_opt_count();
   static qint64 trackfilter_parse_time_opt(const QString& arg);
   static bool trackfilter_init_sort_cb(const route_head* ha, const route_head* hb);
-  static bool trackfilter_merge_sort_cb(const Waypoint* wa, const Waypoint* wb);
   fix_type trackfilter_parse_fix(int* nsats);
   static QDateTime trackfilter_get_first_time(const route_head* track);
   static QDateTime trackfilter_get_last_time(const route_head* track);
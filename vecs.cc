@@ -66,6 +66,7 @@
 #include "nmea.h"              // for NmeaFormat
 #include "option.h"            // for Option, OptionBool
 #include "osm.h"               // for OsmFormat
+#include "osmpbf.h"            // for OsmPbfFormat
 #include "ozi.h"               // for OziFormat
 #include "qstarz_bl_1000.h"    // for QstarzBL1000Format
 #include "random.h"            // for RandomFormat
@@ -129,6 +130,7 @@ struct Vecs::Impl {
   Dg200SerialFormat dg200_fmt;
   Dg200FileFormat dg200_ffmt;
   OsmFormat osm_fmt;
+  OsmPbfFormat osmpbf_fmt;
   ExifFormat exif_fmt;
   HumminbirdFormat humminbird_fmt;
   HumminbirdHTFormat humminbird_ht_fmt;
@@ -373,6 +375,13 @@ struct Vecs::Impl {
       "osm",
       nullptr,
     },
+    {
+      &osmpbf_fmt,
+      "osmpbf",
+      "OpenStreetMap PBF data files",
+      "pbf",
+      nullptr,
+    },
     {
       &exif_fmt,
       "exif",
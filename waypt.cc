@@ -19,6 +19,7 @@
 
  */
 
+#include <algorithm>            // for max
 #include <cassert>              // for assert
 #include <cmath>                // for fabs
 #include <cstdio>               // for fflush, fprintf, stdout
@@ -61,6 +62,16 @@ waypt_add(Waypoint* wpt)
   global_waypoint_list->waypt_add(wpt);
 }
 
+/*
+ * Hint that the global list is about to grow to n waypoints.
+ * Counts read from input files should be limited by the caller.
+ */
+void
+waypt_reserve(qsizetype n)
+{
+  global_waypoint_list->reserve(n);
+}
+
 void
 waypt_del(Waypoint* wpt)
 {
@@ -190,6 +201,12 @@ waypt_swap(WaypointList& other)
   global_waypoint_list->swap(other);
 }
 
+void
+waypt_splice(WaypointList& src)
+{
+  global_waypoint_list->splice(src);
+}
+
 void
 waypt_add_url(Waypoint* wpt, const QString& link, const QString& url_link_text)
 {
@@ -631,6 +648,21 @@ WaypointList::waypt_add(Waypoint* wpt)
 
 }
 
+/*
+ * Readers that know how many points follow can pre-size the list.
+ * When the count comes straight from the input file the caller should
+ * limit it, so a corrupt file can't make us allocate wildly.
+ * Readers that add batches hint once per batch, so the list grows at
+ * least geometrically instead of being reallocated to fit each batch.
+ */
+void
+WaypointList::reserve(qsizetype n)
+{
+  if (n > capacity()) {
+    QList<Waypoint*>::reserve(std::max(n, 2 * capacity()));
+  }
+}
+
 void
 WaypointList::add_rte_waypt(int waypt_ct, Waypoint* wpt, bool synth, QStringView namepart, int number_digits)
 {
@@ -644,6 +676,23 @@ WaypointList::add_rte_waypt(int waypt_ct, Waypoint* wpt, bool synth, QStringView
   }
 }
 
+/* Like add_rte_waypt() for each of wpts, appended in one go. */
+void
+WaypointList::add_rte_waypts(int waypt_ct, const QList<Waypoint*>& wpts, bool synth, QStringView namepart, int number_digits)
+{
+  append(wpts);
+
+  for (Waypoint* wpt : wpts) {
+    ++waypt_ct;
+    wpt->NormalizePosition();
+
+    if (synth && wpt->shortname.isEmpty()) {
+      wpt->shortname = QStringLiteral("%1%2").arg(namepart).arg(waypt_ct, number_digits, 10, QChar('0'));
+      wpt->wpt_flags.shortname_is_synthetic = 1;
+    }
+  }
+}
+
 void
 WaypointList::waypt_del(Waypoint* wpt)
 {
@@ -745,3 +794,19 @@ void WaypointList::swap(WaypointList& other)
   *this = other;
   other = tmp_list;
 }
+
+/*
+ * Like copy() followed by src.flush(), but the waypoints change owner
+ * instead of being duplicated and then deleted.
+ */
+void WaypointList::splice(WaypointList& src)
+{
+  if (&src == this) {
+    return;
+  }
+  reserve(count() + src.count());
+  for (Waypoint* wpt : std::as_const(src)) {
+    waypt_add(wpt);
+  }
+  src.clear();
+}
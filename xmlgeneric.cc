@@ -184,7 +184,7 @@ void XmlGenericReader::xml_read()
 
   file.open(QIODevice::ReadOnly);
 
-  QXmlStreamReader reader(&file);
+  QXmlStreamReader reader(file.device());
 
   xml_run_parser(reader);
   if (reader.hasError())  {
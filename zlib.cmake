@@ -53,6 +53,8 @@ else()
       if(HAVE_STDARG_H)
         target_compile_definitions(z PRIVATE HAVE_STDARG_H)
       endif()
+      # match the z_off_t seen by gpsbabel, which is built with 64-bit off_t.
+      target_compile_definitions(z PRIVATE _FILE_OFFSET_BITS=64)
     endif()
     if(MSVC)
       target_compile_definitions(z PRIVATE _CRT_SECURE_NO_WARNINGS)